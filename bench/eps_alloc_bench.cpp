@@ -0,0 +1,227 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* eps_alloc_bench.cpp												    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+
+/*
+ * Allocation pattern of the eps workers.
+ *
+ * Each thread clones and deletes "spaces" like a depth-first search: a
+ * space is a large block with a few dozen small ones, the live spaces
+ * form a path, and some spaces (the solutions) are deleted by another
+ * thread. The throughput is reported for several numbers of threads, to
+ * compare the allocator the executable is linked with (eps-alloc-bench
+ * uses the system malloc, eps-alloc-bench-jemalloc uses jemalloc).
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+#ifndef ALLOCATOR_NAME
+#define ALLOCATOR_NAME malloc
+#endif
+#define STRINGIFY_NAME(x) #x
+#define STRING_NAME(x) STRINGIFY_NAME(x)
+
+/// A cloned space: one large block and small ones
+struct Space {
+    char* memory;
+    std::vector<char*> objects;
+};
+
+/// Spaces deleted by another thread than the one which allocated them
+struct Mailbox {
+    std::mutex m;
+    std::vector<Space*> spaces;
+};
+
+/// Fast per thread random numbers
+struct Random {
+    unsigned long long int x;
+    Random(unsigned long long int seed) : x(seed * 2654435761ULL + 1) {}
+    unsigned int next(unsigned int n) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return static_cast<unsigned int>(x % n);
+    }
+};
+
+static Space*
+newSpace(Random& r) {
+    Space* s = new Space;
+    s->memory = static_cast<char*>(malloc(2048 + r.next(14 * 1024)));
+    s->memory[0] = 1;
+    unsigned int n = 8 + r.next(56);
+    s->objects.reserve(n);
+    for(unsigned int i = 0; i < n; i++) {
+        char* o = static_cast<char*>(malloc(16 + r.next(240)));
+        o[0] = 1;
+        s->objects.push_back(o);
+    }
+    return s;
+}
+
+static void
+deleteSpace(Space* s) {
+    for(size_t i = 0; i < s->objects.size(); i++) {
+        free(s->objects[i]);
+    }
+    free(s->memory);
+    delete s;
+}
+
+/// Run \a ops clone/delete operations on a search path of at most \a depth spaces
+static void
+work(unsigned int id, unsigned long int ops, unsigned int depth, Mailbox& mailbox) {
+    Random r(id + 1);
+    std::vector<Space*> path;
+    for(unsigned long int i = 0; i < ops; i++) {
+        if(path.empty() || (path.size() < depth && r.next(2))) {
+            path.push_back(newSpace(r));
+        } else {
+            Space* s = path.back();
+            path.pop_back();
+            //One space out of 64 is a solution, deleted by the next thread reporting one
+            if(r.next(64) == 0) {
+                std::lock_guard<std::mutex> lock(mailbox.m);
+                mailbox.spaces.push_back(s);
+                if(mailbox.spaces.size() > 1) {
+                    s = mailbox.spaces.front();
+                    mailbox.spaces.erase(mailbox.spaces.begin());
+                } else {
+                    s = NULL;
+                }
+            }
+            if(s) {
+                deleteSpace(s);
+            }
+        }
+    }
+    for(size_t i = 0; i < path.size(); i++) {
+        deleteSpace(path[i]);
+    }
+}
+
+static std::vector<unsigned int>
+parseThreads(const std::string& s) {
+    std::vector<unsigned int> v;
+    std::istringstream is(s);
+    std::string item;
+    while(std::getline(is, item, ',')) {
+        int n = atoi(item.c_str());
+        if(n > 0) {
+            v.push_back(n);
+        }
+    }
+    return v;
+}
+
+static void
+usage(const char* name) {
+    std::cerr << "usage: " << name << " [options]\n"
+              << "  -p <n,...>     numbers of threads (default 1,2,4,8,16,32,64)\n"
+              << "  -ops <n>       clone/delete operations per thread (default 200000)\n"
+              << "  -depth <n>     maximum number of live spaces per thread (default 32)\n"
+              << "  -csv           print a csv report\n";
+}
+
+int
+main(int argc, char* argv[]) {
+    std::vector<unsigned int> threads = parseThreads("1,2,4,8,16,32,64");
+    unsigned long int ops = 200000;
+    unsigned int depth = 32;
+    bool csv = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-p") && i + 1 < argc) {
+            threads = parseThreads(argv[++i]);
+        } else if(!strcmp(argv[i], "-ops") && i + 1 < argc) {
+            ops = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-depth") && i + 1 < argc) {
+            depth = std::max(1, atoi(argv[++i]));
+        } else if(!strcmp(argv[i], "-csv")) {
+            csv = true;
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "-help") ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    }
+
+    const char* allocator = STRING_NAME(ALLOCATOR_NAME);
+    if(csv) {
+        std::cout << "allocator,threads,time_ms,mops_per_s" << std::endl;
+    } else {
+        std::cout << std::setw(10) << "allocator" << std::setw(9) << "threads"
+                  << std::setw(12) << "time(ms)" << std::setw(12) << "Mops/s" << std::endl;
+    }
+
+    for(size_t t = 0; t < threads.size(); t++) {
+        Mailbox mailbox;
+        std::vector<std::thread> pool;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(unsigned int i = 0; i < threads[t]; i++) {
+            pool.push_back(std::thread(work, i, ops, depth, std::ref(mailbox)));
+        }
+        for(size_t i = 0; i < pool.size(); i++) {
+            pool[i].join();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for(size_t i = 0; i < mailbox.spaces.size(); i++) {
+            deleteSpace(mailbox.spaces[i]);
+        }
+
+        double mops = ms > 0.0 ? (threads[t] * ops) / (ms * 1000.0) : 0.0;
+        if(csv) {
+            std::cout << allocator << "," << threads[t] << "," << ms << "," << mops << std::endl;
+        } else {
+            std::cout << std::setw(10) << allocator << std::setw(9) << threads[t]
+                      << std::setw(12) << std::fixed << std::setprecision(1) << ms
+                      << std::setw(12) << std::setprecision(2) << mops << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,524 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* eps_bench.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Benchmark driver of eps-gecode.
+ *
+ * Runs the matrix declared in a json file (instances and built-in models,
+ * search engines, decomposition modes, number of problems per worker and
+ * number of workers), repeats each run and writes a json and/or csv report
+ * with the wall time, the speedup against one worker, the overhead of the
+ * decomposition and the imbalance of the workers.
+ *
+ * Matrix format (see matrix.json):
+ *   {
+ *     "binary": "bin/Release/eps-gecode",
+ *     "repeats": 3,
+ *     "time": 600000,                       (limit of one run in ms, 0 = none)
+ *     "options": "",                         (added to every run)
+ *     "threads": [1, 2, 4, 8],
+ *     "problems_per_worker": [30],           (-problems = value * threads)
+ *     "mode_decomposition": [1, 2],
+ *     "search": ["eps"],
+ *     "instances": ["instances/golomb_09.fzn"],
+ *     "models": [{"name": "nqueens", "sizes": [12]}]
+ *   }
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <sys/time.h>
+
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+/// One benchmark: an instance file or a model with a size
+struct Benchmark {
+    std::string name;
+    std::string args;
+};
+
+/// One configuration of the engine
+struct Configuration {
+    std::string search;
+    unsigned int mode_decomposition;
+    unsigned int problems_per_worker;
+    unsigned int threads;
+};
+
+/// Statistics of one run parsed from -mode stat
+struct Run {
+    bool ok;
+    double wall;
+    double runtime;
+    double decomposition;
+    double max_inactivity;
+    double sum_problems;
+    double min_problem;
+    double max_problem;
+    unsigned int problems;
+    unsigned int solutions;
+    bool stopped;
+    std::string status;
+};
+
+/// Aggregated result of a configuration
+struct Result {
+    Benchmark bench;
+    Configuration conf;
+    std::vector<Run> runs;
+
+    double wall;
+    double decomposition;
+    double overhead;
+    double speedup;
+    double efficiency;
+};
+
+static double
+now(void) {
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+}
+
+static double
+median(std::vector<double> v) {
+    if(v.empty()) {
+        return 0.0;
+    }
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+/// Value in ms of a statistic line "%%  name:     x.y (N ms)"
+static double
+milliseconds(const std::string& line) {
+    size_t pos = line.find('(');
+    return pos == std::string::npos ? 0.0 : strtod(line.c_str() + pos + 1, NULL);
+}
+
+/// Value of a statistic line "%%  name:     value"
+static std::string
+value(const std::string& line) {
+    size_t pos = line.find(':');
+    if(pos == std::string::npos) {
+        return "";
+    }
+    pos = line.find_first_not_of(" \t", pos + 1);
+    return pos == std::string::npos ? "" : line.substr(pos);
+}
+
+static Run
+execute(const std::string& command) {
+    Run r;
+    r.ok = false;
+    r.wall = r.runtime = r.decomposition = r.max_inactivity = 0.0;
+    r.sum_problems = r.min_problem = r.max_problem = 0.0;
+    r.problems = r.solutions = 0;
+    r.stopped = false;
+
+    double start = now();
+    FILE* out = popen(command.c_str(), "r");
+    if(!out) {
+        return r;
+    }
+
+    std::string output;
+    char buffer[4096];
+    size_t n;
+    while((n = fread(buffer, 1, sizeof(buffer), out)) > 0) {
+        output.append(buffer, n);
+    }
+    int status = pclose(out);
+    r.wall = now() - start;
+
+    std::istringstream is(output);
+    std::string line;
+    while(std::getline(is, line)) {
+        if(line.compare(0, 4, "%%  ") != 0) {
+            continue;
+        }
+        if(line.find("%%  runtime:") == 0) {
+            r.runtime = milliseconds(line);
+            r.ok = true;
+        } else if(line.find("%%  time decomposition:") == 0) {
+            r.decomposition = milliseconds(line);
+        } else if(line.find("%%  time max inactivity worker:") == 0) {
+            r.max_inactivity = milliseconds(line);
+        } else if(line.find("%%  sum time problems:") == 0) {
+            r.sum_problems = milliseconds(line);
+        } else if(line.find("%%  min time problems:") == 0) {
+            r.min_problem = milliseconds(line);
+        } else if(line.find("%%  max time problems:") == 0) {
+            r.max_problem = milliseconds(line);
+        } else if(line.find("%%  generated problems decomposition:") == 0) {
+            r.problems = atoi(value(line).c_str());
+        } else if(line.find("%%  solutions:") == 0) {
+            r.solutions = atoi(value(line).c_str());
+        } else if(line.find("%%  is search stopped:") == 0) {
+            r.stopped = atoi(value(line).c_str()) != 0;
+        } else if(line.find("%%  status:") == 0) {
+            r.status = value(line);
+        }
+    }
+    r.ok = r.ok && status == 0;
+    return r;
+}
+
+static std::string
+commandLine(const std::string& binary, const std::string& options, unsigned int time,
+            const Benchmark& b, const Configuration& c) {
+    std::ostringstream cmd;
+    cmd << binary << " -mode stat"
+        << " -search " << c.search
+        << " -p " << c.threads
+        << " -problems " << c.problems_per_worker * c.threads
+        << " -mode_decomposition " << c.mode_decomposition;
+    if(time) {
+        cmd << " -time " << time;
+    }
+    if(!options.empty()) {
+        cmd << " " << options;
+    }
+    cmd << " " << b.args << " 2>/dev/null";
+    return cmd.str();
+}
+
+static std::vector<unsigned int>
+unsignedArray(const rapidjson::Value& d, const char* name, unsigned int def) {
+    std::vector<unsigned int> v;
+    if(d.HasMember(name) && d[name].IsArray()) {
+        for(rapidjson::SizeType i = 0; i < d[name].Size(); i++) {
+            v.push_back(d[name][i].GetUint());
+        }
+    }
+    if(v.empty()) {
+        v.push_back(def);
+    }
+    return v;
+}
+
+static std::vector<std::string>
+stringArray(const rapidjson::Value& d, const char* name) {
+    std::vector<std::string> v;
+    if(d.HasMember(name) && d[name].IsArray()) {
+        for(rapidjson::SizeType i = 0; i < d[name].Size(); i++) {
+            v.push_back(d[name][i].GetString());
+        }
+    }
+    return v;
+}
+
+static void
+writeJson(std::ostream& os, const std::vector<Result>& results) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartArray();
+    for(size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        writer.StartObject();
+        writer.String("benchmark");
+        writer.String(r.bench.name.c_str());
+        writer.String("search");
+        writer.String(r.conf.search.c_str());
+        writer.String("mode_decomposition");
+        writer.Uint(r.conf.mode_decomposition);
+        writer.String("problems");
+        writer.Uint(r.conf.problems_per_worker * r.conf.threads);
+        writer.String("threads");
+        writer.Uint(r.conf.threads);
+        writer.String("wall_ms");
+        writer.Double(r.wall);
+        writer.String("speedup");
+        writer.Double(r.speedup);
+        writer.String("decomposition_ms");
+        writer.Double(r.decomposition);
+        writer.String("decomposition_overhead");
+        writer.Double(r.overhead);
+        writer.String("efficiency");
+        writer.Double(r.efficiency);
+        writer.String("imbalance");
+        writer.Double(1.0 - r.efficiency);
+        writer.String("runs");
+        writer.StartArray();
+        for(size_t j = 0; j < r.runs.size(); j++) {
+            const Run& run = r.runs[j];
+            writer.StartObject();
+            writer.String("ok");
+            writer.Bool(run.ok);
+            writer.String("wall_ms");
+            writer.Double(run.wall);
+            writer.String("runtime_ms");
+            writer.Double(run.runtime);
+            writer.String("decomposition_ms");
+            writer.Double(run.decomposition);
+            writer.String("max_inactivity_ms");
+            writer.Double(run.max_inactivity);
+            writer.String("sum_problems_ms");
+            writer.Double(run.sum_problems);
+            writer.String("min_problem_ms");
+            writer.Double(run.min_problem);
+            writer.String("max_problem_ms");
+            writer.Double(run.max_problem);
+            writer.String("generated_problems");
+            writer.Uint(run.problems);
+            writer.String("solutions");
+            writer.Uint(run.solutions);
+            writer.String("stopped");
+            writer.Bool(run.stopped);
+            writer.String("status");
+            writer.String(run.status.c_str());
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    os << buffer.GetString() << std::endl;
+}
+
+static void
+writeCsv(std::ostream& os, const std::vector<Result>& results) {
+    os << "benchmark,search,mode_decomposition,problems,threads,repeats,wall_ms,speedup,"
+       << "decomposition_ms,decomposition_overhead,efficiency,imbalance,max_inactivity_ms,max_problem_ms,status"
+       << std::endl;
+    for(size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::vector<double> inactivity, max_problem;
+        for(size_t j = 0; j < r.runs.size(); j++) {
+            inactivity.push_back(r.runs[j].max_inactivity);
+            max_problem.push_back(r.runs[j].max_problem);
+        }
+        os << r.bench.name << "," << r.conf.search << "," << r.conf.mode_decomposition << ","
+           << r.conf.problems_per_worker * r.conf.threads << "," << r.conf.threads << ","
+           << r.runs.size() << "," << r.wall << "," << r.speedup << ","
+           << r.decomposition << "," << r.overhead << ","
+           << r.efficiency << "," << 1.0 - r.efficiency << ","
+           << median(inactivity) << "," << median(max_problem) << ","
+           << (r.runs.empty() ? "" : r.runs.back().status) << std::endl;
+    }
+}
+
+static void
+usage(const char* name) {
+    std::cerr << "usage: " << name << " [options] matrix.json\n"
+              << "  -bin <path>    eps-gecode binary (default from the matrix)\n"
+              << "  -o <file>      json report (default stdout)\n"
+              << "  -csv <file>    csv report\n"
+              << "  -dry           print the command lines without running them\n";
+}
+
+int
+main(int argc, char* argv[]) {
+    const char* matrix = NULL;
+    const char* binary = NULL;
+    const char* json_file = NULL;
+    const char* csv_file = NULL;
+    bool dry = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-bin") && i + 1 < argc) {
+            binary = argv[++i];
+        } else if(!strcmp(argv[i], "-o") && i + 1 < argc) {
+            json_file = argv[++i];
+        } else if(!strcmp(argv[i], "-csv") && i + 1 < argc) {
+            csv_file = argv[++i];
+        } else if(!strcmp(argv[i], "-dry")) {
+            dry = true;
+        } else if(argv[i][0] == '-') {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            matrix = argv[i];
+        }
+    }
+
+    if(!matrix) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in(matrix);
+    if(!in.good()) {
+        std::cerr << "Could not open file " << matrix << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    rapidjson::Document d;
+    d.Parse<0>(text.c_str());
+    if(d.HasParseError() || !d.IsObject()) {
+        std::cerr << "Invalid matrix " << matrix << ": " << (d.HasParseError() ? d.GetParseError() : "not an object") << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string bin = binary ? binary : (d.HasMember("binary") ? d["binary"].GetString() : "bin/Release/eps-gecode");
+    std::string options = d.HasMember("options") ? d["options"].GetString() : "";
+    unsigned int repeats = d.HasMember("repeats") ? d["repeats"].GetUint() : 1;
+    unsigned int time = d.HasMember("time") ? d["time"].GetUint() : 0;
+
+    std::vector<unsigned int> threads = unsignedArray(d, "threads", 1);
+    std::vector<unsigned int> problems = unsignedArray(d, "problems_per_worker", 30);
+    std::vector<unsigned int> modes = unsignedArray(d, "mode_decomposition", 1);
+    std::vector<std::string> searches = stringArray(d, "search");
+    if(searches.empty()) {
+        searches.push_back("eps");
+    }
+
+    //The speedup is computed against one worker
+    if(std::find(threads.begin(), threads.end(), 1) == threads.end()) {
+        threads.insert(threads.begin(), 1);
+    }
+    std::sort(threads.begin(), threads.end());
+
+    std::vector<Benchmark> benchs;
+    std::vector<std::string> instances = stringArray(d, "instances");
+    for(size_t i = 0; i < instances.size(); i++) {
+        Benchmark b;
+        b.name = instances[i];
+        b.args = instances[i];
+        benchs.push_back(b);
+    }
+    if(d.HasMember("models") && d["models"].IsArray()) {
+        const rapidjson::Value& models = d["models"];
+        for(rapidjson::SizeType i = 0; i < models.Size(); i++) {
+            std::string model = models[i]["name"].GetString();
+            std::string args = models[i].HasMember("args") ? models[i]["args"].GetString() : "";
+            std::vector<unsigned int> sizes = unsignedArray(models[i], "sizes", 0);
+            for(size_t j = 0; j < sizes.size(); j++) {
+                std::ostringstream name, cmd;
+                name << model;
+                cmd << "-model " << model;
+                if(sizes[j]) {
+                    name << "_" << sizes[j];
+                    cmd << " -nsize " << sizes[j];
+                }
+                cmd << " " << args;
+                Benchmark b;
+                b.name = name.str();
+                b.args = cmd.str();
+                benchs.push_back(b);
+            }
+        }
+    }
+
+    std::vector<Result> results;
+    for(size_t b = 0; b < benchs.size(); b++) {
+        for(size_t s = 0; s < searches.size(); s++) {
+            for(size_t m = 0; m < modes.size(); m++) {
+                for(size_t p = 0; p < problems.size(); p++) {
+                    double sequential = 0.0;
+                    for(size_t t = 0; t < threads.size(); t++) {
+                        Result r;
+                        r.bench = benchs[b];
+                        r.conf.search = searches[s];
+                        r.conf.mode_decomposition = modes[m];
+                        r.conf.problems_per_worker = problems[p];
+                        r.conf.threads = threads[t];
+
+                        std::string cmd = commandLine(bin, options, time, r.bench, r.conf);
+                        if(dry) {
+                            std::cout << cmd << std::endl;
+                            continue;
+                        }
+
+                        std::vector<double> wall, decomposition, overhead, efficiency;
+                        for(unsigned int k = 0; k < repeats; k++) {
+                            std::cerr << "[" << r.bench.name << " " << r.conf.search << " -mode_decomposition "
+                                      << r.conf.mode_decomposition << " -problems " << r.conf.problems_per_worker * r.conf.threads
+                                      << " -p " << r.conf.threads << "] run " << k + 1 << "/" << repeats << std::endl;
+                            Run run = execute(cmd);
+                            r.runs.push_back(run);
+                            if(!run.ok) {
+                                std::cerr << "  failed: " << cmd << std::endl;
+                                continue;
+                            }
+                            wall.push_back(run.wall);
+                            decomposition.push_back(run.decomposition);
+                            overhead.push_back(run.runtime > 0.0 ? run.decomposition / run.runtime : 0.0);
+                            //Share of the capacity of the workers spent in subproblems
+                            double capacity = r.conf.threads * (run.runtime - run.decomposition);
+                            efficiency.push_back(capacity > 0.0 ? std::min(1.0, run.sum_problems / capacity) : 0.0);
+                        }
+
+                        r.wall = median(wall);
+                        r.decomposition = median(decomposition);
+                        r.overhead = median(overhead);
+                        r.efficiency = median(efficiency);
+                        if(r.conf.threads == 1) {
+                            sequential = r.wall;
+                        }
+                        r.speedup = r.wall > 0.0 ? sequential / r.wall : 0.0;
+                        results.push_back(r);
+                    }
+                }
+            }
+        }
+    }
+
+    if(dry) {
+        return EXIT_SUCCESS;
+    }
+
+    if(json_file) {
+        std::ofstream os(json_file);
+        writeJson(os, results);
+    } else if(!csv_file) {
+        writeJson(std::cout, results);
+    }
+
+    if(csv_file) {
+        std::ofstream os(csv_file);
+        writeCsv(os, results);
+    }
+
+    return EXIT_SUCCESS;
+}
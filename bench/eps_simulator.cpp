@@ -0,0 +1,458 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* eps_simulator.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Offline simulation of the dispatch of eps subproblems.
+ *
+ * The durations of the subproblems are read from the statistics printed
+ * by eps-gecode in -mode stat ("trace problems" if present, otherwise
+ * "time problems") or from a plain list of durations in ms. The dispatch
+ * policies are replayed for several numbers of workers to predict the
+ * makespan, the speedup and the idle time of the workers.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+/// A recorded subproblem
+struct Task {
+    /// Rank in generation order
+    unsigned int id;
+    /// Estimated hardness (0 if not recorded)
+    double hardness;
+    /// Measured duration in ms
+    double duration;
+};
+
+/// Recorded run
+struct Record {
+    std::vector<Task> tasks;
+    /// Duration of the decomposition in ms
+    double decomposition;
+
+    Record(void) : decomposition(0.0) {}
+};
+
+/// Dispatch policy
+struct Policy {
+    std::string name;
+    /// Order of the shared queue
+    enum Order {
+        GENERATION, //< order of generation
+        LONGEST,    //< longest measured duration first (oracle)
+        ESTIMATED   //< highest estimated hardness first
+    } order;
+    /// Subproblems taken at once from the shared queue
+    unsigned int chunk;
+    /// Chunks shrinking with the subproblems left (chunk is the minimum)
+    bool guided;
+    /// Subproblems assigned round robin before the start (no shared queue)
+    bool assigned;
+    /// Idle workers steal half of the waiting subproblems of the most loaded worker
+    bool steal;
+};
+
+/// Result of a simulation
+struct Result {
+    double makespan;
+    double idle;
+};
+
+static bool
+parsePolicy(const std::string& s, unsigned int chunk, Policy& p) {
+    p.name = s;
+    p.order = Policy::GENERATION;
+    p.chunk = 1;
+    p.guided = false;
+    p.assigned = false;
+    p.steal = false;
+
+    std::string base = s;
+    size_t plus = s.find("+steal");
+    if(plus != std::string::npos) {
+        p.steal = true;
+        base = s.substr(0, plus);
+    }
+
+    if(base == "fifo") {
+    } else if(base == "lpt") {
+        p.order = Policy::LONGEST;
+    } else if(base == "lpt-est") {
+        p.order = Policy::ESTIMATED;
+    } else if(base == "chunk") {
+        p.chunk = chunk;
+    } else if(base == "guided") {
+        p.chunk = chunk;
+        p.guided = true;
+    } else if(base == "static") {
+        p.assigned = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Simulate \a p with \a workers workers, each dispatch costs \a overhead ms
+static Result
+simulate(const Record& r, const Policy& p, unsigned int workers, double overhead) {
+    std::vector<unsigned int> queue(r.tasks.size());
+    for(size_t i = 0; i < queue.size(); i++) {
+        queue[i] = i;
+    }
+    if(p.order == Policy::LONGEST) {
+        std::stable_sort(queue.begin(), queue.end(), [&r](unsigned int a, unsigned int b) {
+            return r.tasks[a].duration > r.tasks[b].duration;
+        });
+    } else if(p.order == Policy::ESTIMATED) {
+        std::stable_sort(queue.begin(), queue.end(), [&r](unsigned int a, unsigned int b) {
+            return r.tasks[a].hardness > r.tasks[b].hardness;
+        });
+    }
+
+    std::vector<double> free_at(workers, r.decomposition);
+    std::vector<double> busy(workers, 0.0);
+    std::vector<bool> done(workers, false);
+    std::vector< std::deque<unsigned int> > local(workers);
+
+    size_t next = 0;
+    if(p.assigned) {
+        for(size_t i = 0; i < queue.size(); i++) {
+            local[i % workers].push_back(queue[i]);
+        }
+        next = queue.size();
+    }
+
+    //The shared queue is protected by a lock held during a dispatch
+    double lock_free_at = r.decomposition;
+    unsigned int running = workers;
+
+    while(running) {
+        unsigned int w = workers;
+        for(unsigned int i = 0; i < workers; i++) {
+            if(!done[i] && (w == workers || free_at[i] < free_at[w])) {
+                w = i;
+            }
+        }
+
+        unsigned int task;
+        double start;
+        if(!local[w].empty()) {
+            task = local[w].front();
+            local[w].pop_front();
+            start = free_at[w] + overhead;
+        } else if(next < queue.size()) {
+            double acquired = std::max(free_at[w], lock_free_at);
+            lock_free_at = acquired + overhead;
+            unsigned int chunk = p.chunk;
+            if(p.guided) {
+                //Same rule as eps-gecode -chunk guided
+                chunk = std::max<unsigned int>(chunk, (queue.size() - next) / (2 * workers));
+            }
+            task = queue[next++];
+            for(unsigned int k = 1; k < chunk && next < queue.size(); k++) {
+                local[w].push_back(queue[next++]);
+            }
+            start = lock_free_at;
+        } else {
+            unsigned int victim = workers;
+            if(p.steal) {
+                for(unsigned int i = 0; i < workers; i++) {
+                    if(local[i].size() && (victim == workers || local[i].size() > local[victim].size())) {
+                        victim = i;
+                    }
+                }
+            }
+            if(victim == workers) {
+                done[w] = true;
+                running--;
+                continue;
+            }
+            size_t n = (local[victim].size() + 1) / 2;
+            for(size_t k = 0; k < n; k++) {
+                local[w].push_front(local[victim].back());
+                local[victim].pop_back();
+            }
+            task = local[w].front();
+            local[w].pop_front();
+            start = free_at[w] + overhead;
+        }
+
+        busy[w] += r.tasks[task].duration;
+        free_at[w] = start + r.tasks[task].duration;
+    }
+
+    Result res;
+    res.makespan = *std::max_element(free_at.begin(), free_at.end());
+    res.idle = 0.0;
+    for(unsigned int i = 0; i < workers; i++) {
+        res.idle += res.makespan - r.decomposition - busy[i];
+    }
+    return res;
+}
+
+/// First number of \a s after \a prefix (or \a def)
+static double
+numberAfter(const std::string& s, const std::string& prefix, double def) {
+    size_t pos = s.find(prefix);
+    if(pos == std::string::npos) {
+        return def;
+    }
+    return strtod(s.c_str() + pos + prefix.size(), NULL);
+}
+
+/// Read the durations of the subproblems of \a in
+static bool
+readRecord(std::istream& in, Record& r) {
+    std::vector<Task> times;
+    std::vector<Task> trace;
+    std::vector<Task> plain;
+
+    std::string line;
+    while(std::getline(in, line)) {
+        if(line.compare(0, 2, "%%") == 0) {
+            if(line.find("%%  time decomposition:") == 0) {
+                //"x.yyy (N ms)"
+                r.decomposition = numberAfter(line, "(", 0.0);
+            } else if(line.find("%%  trace problems") == 0) {
+                std::istringstream is(line.substr(line.find("):") + 2));
+                std::string item;
+                while(is >> item) {
+                    Task t;
+                    unsigned int worker;
+                    double seconds;
+                    if(sscanf(item.c_str(), "%u:%u:%lf:%lf", &t.id, &worker, &t.hardness, &seconds) == 4) {
+                        t.duration = seconds * 1000.0;
+                        trace.push_back(t);
+                    }
+                }
+            } else if(line.find("%%  time problems:") == 0) {
+                std::istringstream is(line.substr(strlen("%%  time problems:")));
+                double seconds;
+                while(is >> seconds) {
+                    Task t;
+                    t.id = times.size();
+                    t.hardness = 0.0;
+                    t.duration = seconds * 1000.0;
+                    times.push_back(t);
+                }
+            }
+        } else {
+            std::istringstream is(line);
+            double ms;
+            while(is >> ms) {
+                Task t;
+                t.id = plain.size();
+                t.hardness = 0.0;
+                t.duration = ms;
+                plain.push_back(t);
+            }
+        }
+    }
+
+    if(trace.size()) {
+        //Back to generation order
+        std::sort(trace.begin(), trace.end(), [](const Task& a, const Task& b) {
+            return a.id < b.id;
+        });
+        r.tasks = trace;
+    } else if(times.size()) {
+        r.tasks = times;
+    } else {
+        r.tasks = plain;
+    }
+    return !r.tasks.empty();
+}
+
+/// Numbers of workers of \a s, empty if one of them is not a positive integer
+static std::vector<unsigned int>
+parseWorkers(const char* s) {
+    std::vector<unsigned int> v;
+    std::istringstream is(s);
+    std::string item;
+    while(std::getline(is, item, ',')) {
+        char* end;
+        long n = strtol(item.c_str(), &end, 10);
+        if(item.empty() || *end != '\0' || n < 1) {
+            return std::vector<unsigned int>();
+        }
+        v.push_back(n);
+    }
+    return v;
+}
+
+static void
+usage(const char* name) {
+    std::cerr << "usage: " << name << " [options] [file]\n"
+              << "  -p <n,...>          numbers of workers (default 1,2,4,8,16,32,64)\n"
+              << "  -policy <p,...>     policies among fifo, lpt, lpt-est, chunk, guided, static,\n"
+              << "                      each with an optional +steal suffix (default all)\n"
+              << "  -chunk <n>          subproblems taken at once by the chunk policy, minimum of\n"
+              << "                      the guided policy (default 4)\n"
+              << "  -overhead <ms>      cost of a dispatch, taken under the lock for the shared\n"
+              << "                      queue (default 0, see \"dispatch problems\" in the stats)\n"
+              << "  -decomposition <ms> duration of the decomposition (default from the stats)\n"
+              << "  -csv                print a csv report\n"
+              << "The file (default stdin) is the output of eps-gecode -mode stat or a list of\n"
+              << "durations in ms.\n";
+}
+
+int
+main(int argc, char* argv[]) {
+    std::vector<unsigned int> workers = parseWorkers("1,2,4,8,16,32,64");
+    std::string policies = "fifo,lpt,lpt-est,chunk,chunk+steal,guided,static,static+steal";
+    unsigned int chunk = 4;
+    double overhead = 0.0;
+    double decomposition = -1.0;
+    bool csv = false;
+    const char* file = NULL;
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-p") && i + 1 < argc) {
+            workers = parseWorkers(argv[++i]);
+            if(workers.empty()) {
+                std::cerr << "Invalid numbers of workers " << argv[i] << std::endl;
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if(!strcmp(argv[i], "-policy") && i + 1 < argc) {
+            policies = argv[++i];
+        } else if(!strcmp(argv[i], "-chunk") && i + 1 < argc) {
+            chunk = std::max(1, atoi(argv[++i]));
+        } else if(!strcmp(argv[i], "-overhead") && i + 1 < argc) {
+            overhead = atof(argv[++i]);
+        } else if(!strcmp(argv[i], "-decomposition") && i + 1 < argc) {
+            decomposition = atof(argv[++i]);
+        } else if(!strcmp(argv[i], "-csv")) {
+            csv = true;
+        } else if(!strcmp(argv[i], "-help") || argv[i][0] == '-') {
+            usage(argv[0]);
+            return strcmp(argv[i], "-help") ? EXIT_FAILURE : EXIT_SUCCESS;
+        } else {
+            file = argv[i];
+        }
+    }
+
+    Record r;
+    bool ok;
+    if(file) {
+        std::ifstream in(file);
+        if(!in.good()) {
+            std::cerr << "Could not open file " << file << std::endl;
+            return EXIT_FAILURE;
+        }
+        ok = readRecord(in, r);
+    } else {
+        ok = readRecord(std::cin, r);
+    }
+    if(!ok) {
+        std::cerr << "No subproblem durations found" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(decomposition >= 0.0) {
+        r.decomposition = decomposition;
+    }
+
+    bool has_hardness = false;
+    double work = 0.0;
+    for(size_t i = 0; i < r.tasks.size(); i++) {
+        work += r.tasks[i].duration;
+        has_hardness = has_hardness || r.tasks[i].hardness != 0.0;
+    }
+
+    std::vector<Policy> pol;
+    std::istringstream is(policies);
+    std::string name;
+    while(std::getline(is, name, ',')) {
+        Policy p;
+        if(!parsePolicy(name, chunk, p)) {
+            std::cerr << "Unknown policy " << name << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(p.order == Policy::ESTIMATED && !has_hardness) {
+            continue;
+        }
+        pol.push_back(p);
+    }
+
+    Policy reference;
+    parsePolicy("fifo", chunk, reference);
+    double sequential = simulate(r, reference, 1, overhead).makespan;
+
+    if(csv) {
+        std::cout << "workers,policy,makespan_ms,speedup,idle_ms,idle_ratio" << std::endl;
+    } else {
+        std::cout << "%%  subproblems:     " << r.tasks.size() << std::endl
+                  << "%%  work:     " << work << " ms" << std::endl
+                  << "%%  decomposition:     " << r.decomposition << " ms" << std::endl
+                  << std::setw(8) << "workers" << std::setw(16) << "policy"
+                  << std::setw(14) << "makespan(ms)" << std::setw(10) << "speedup"
+                  << std::setw(14) << "idle(ms)" << std::setw(8) << "idle%" << std::endl;
+    }
+
+    for(size_t i = 0; i < workers.size(); i++) {
+        for(size_t j = 0; j < pol.size(); j++) {
+            Result res = simulate(r, pol[j], workers[i], overhead);
+            double speedup = res.makespan > 0.0 ? sequential / res.makespan : 0.0;
+            double capacity = workers[i] * (res.makespan - r.decomposition);
+            double ratio = capacity > 0.0 ? res.idle / capacity : 0.0;
+            if(csv) {
+                std::cout << workers[i] << "," << pol[j].name << "," << res.makespan << ","
+                          << speedup << "," << res.idle << "," << ratio << std::endl;
+            } else {
+                std::cout << std::setw(8) << workers[i] << std::setw(16) << pol[j].name
+                          << std::setw(14) << std::fixed << std::setprecision(1) << res.makespan
+                          << std::setw(10) << std::setprecision(2) << speedup
+                          << std::setw(14) << std::setprecision(1) << res.idle
+                          << std::setw(8) << std::setprecision(1) << 100.0 * ratio << std::endl;
+                std::cout.unsetf(std::ios::floatfield);
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
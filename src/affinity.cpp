@@ -0,0 +1,177 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* affinity.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "affinity.h"
+
+/// Parse a cpu list such as "0-3,8-11"
+static std::vector<int>
+parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream is(list);
+    std::string range;
+    while(std::getline(is, range, ',')) {
+        int first, last;
+        int n = sscanf(range.c_str(), "%d-%d", &first, &last);
+        if(n == 1) {
+            last = first;
+        } else if(n != 2) {
+            continue;
+        }
+        for(int c = first; c <= last; c++) {
+            cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+Topology::Topology(void) {
+#if defined(__linux__)
+    //Cpus of the process, a cpu outside of them cannot be pinned on
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool masked = sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0;
+
+    for(int node = 0; ; node++) {
+        std::ostringstream path;
+        path << "/sys/devices/system/node/node" << node << "/cpulist";
+        std::ifstream in(path.str().c_str());
+        if(!in.good()) {
+            break;
+        }
+        std::string list;
+        std::getline(in, list);
+        std::vector<int> cpus;
+        std::vector<int> listed = parseCpuList(list);
+        for(size_t i = 0; i < listed.size(); i++) {
+            if(!masked || (listed[i] < CPU_SETSIZE && CPU_ISSET(listed[i], &allowed))) {
+                cpus.push_back(listed[i]);
+            }
+        }
+        //Memory only nodes, and the nodes out of the mask, have no cpu
+        if(cpus.size()) {
+            _cpus.push_back(cpus);
+        }
+    }
+
+    if(_cpus.empty() && masked) {
+        std::vector<int> cpus;
+        for(int c = 0; c < CPU_SETSIZE; c++) {
+            if(CPU_ISSET(c, &allowed)) {
+                cpus.push_back(c);
+            }
+        }
+        if(cpus.size()) {
+            _cpus.push_back(cpus);
+        }
+    }
+#endif
+
+    if(_cpus.empty()) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        std::vector<int> cpus;
+        for(long c = 0; c < std::max(n, 1L); c++) {
+            cpus.push_back(c);
+        }
+        _cpus.push_back(cpus);
+    }
+}
+
+unsigned int
+Topology::cpus(void) const {
+    unsigned int n = 0;
+    for(size_t i = 0; i < _cpus.size(); i++) {
+        n += _cpus[i].size();
+    }
+    return n;
+}
+
+void
+Topology::place(unsigned int i, bool scatter, int& node, int& cpu) const {
+    i %= cpus();
+    if(scatter) {
+        //Round robin over the nodes, skipping the nodes already full
+        unsigned int k = 0;
+        for(unsigned int round = 0; ; round++) {
+            for(size_t n = 0; n < _cpus.size(); n++) {
+                if(round < _cpus[n].size()) {
+                    if(k == i) {
+                        node = n;
+                        cpu = _cpus[n][round];
+                        return;
+                    }
+                    k++;
+                }
+            }
+        }
+    } else {
+        for(size_t n = 0; n < _cpus.size(); n++) {
+            if(i < _cpus[n].size()) {
+                node = n;
+                cpu = _cpus[n][i];
+                return;
+            }
+            i -= _cpus[n].size();
+        }
+    }
+}
+
+bool
+pinThread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+#else
+    return false;
+#endif
+}
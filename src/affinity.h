@@ -0,0 +1,82 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* affinity.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __AFFINITY_H__
+#define __AFFINITY_H__
+
+#include <vector>
+
+/**
+ * \brief NUMA topology of the machine
+ *
+ * The cpus of each node are read from /sys/devices/system/node, only the
+ * cpus the process is allowed to run on are kept (taskset, cpuset). When
+ * the topology is unknown, the machine is seen as one node holding all
+ * the allowed cpus.
+ */
+class Topology {
+public:
+    /// Read the topology of the machine
+    Topology(void);
+
+    /// Number of NUMA nodes
+    unsigned int nodes(void) const {
+        return _cpus.size();
+    }
+
+    /// Number of cpus
+    unsigned int cpus(void) const;
+
+    /**
+     * \brief Node and cpu of worker \a i
+     *
+     * Compact placement fills the cpus of a node before using the next
+     * one, scatter placement spreads the workers round robin over the
+     * nodes. Workers wrap around when there are more workers than cpus.
+     */
+    void place(unsigned int i, bool scatter, int& node, int& cpu) const;
+
+private:
+    /// Cpus of each node
+    std::vector< std::vector<int> > _cpus;
+};
+
+/// Pin the calling thread on \a cpu, return false if not supported
+bool pinThread(int cpu);
+
+#endif /* __AFFINITY_H__ */
@@ -0,0 +1,135 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* allocator.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <cstddef>
+#include <stdint.h>
+
+#if defined(EPS_JEMALLOC)
+extern "C" int mallctl(const char* name, void* oldp, size_t* oldlenp, void* newp, size_t newlen);
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "allocator.h"
+
+#if defined(EPS_JEMALLOC)
+
+/// Read the jemalloc control \a name (left unchanged if unknown)
+template<class T>
+static void
+readControl(const char* name, T& value) {
+    size_t size = sizeof(T);
+    T v;
+    if(mallctl(name, &v, &size, NULL, 0) == 0) {
+        value = v;
+    }
+}
+
+AllocatorStatistics
+allocatorStatistics(void) {
+    AllocatorStatistics s = {"jemalloc", 0, 0, 0, 0, 0};
+
+    //The statistics are refreshed by a new epoch
+    uint64_t epoch = 1;
+    size_t size = sizeof(epoch);
+    mallctl("epoch", &epoch, &size, &epoch, size);
+
+    readControl("stats.allocated", s.allocated);
+    readControl("stats.active", s.active);
+    readControl("stats.resident", s.resident);
+    readControl("stats.mapped", s.mapped);
+    readControl("arenas.narenas", s.arenas);
+    return s;
+}
+
+bool
+allocatorBindThread(void) {
+    unsigned int arena;
+    size_t size = sizeof(arena);
+    //arenas.create since jemalloc 5, arenas.extend before
+    if(mallctl("arenas.create", &arena, &size, NULL, 0) != 0
+            && mallctl("arenas.extend", &arena, &size, NULL, 0) != 0) {
+        return false;
+    }
+    return mallctl("thread.arena", NULL, NULL, &arena, sizeof(arena)) == 0;
+}
+
+bool
+allocatorThreadCounters(const uint64_t*& allocated, const uint64_t*& deallocated) {
+    uint64_t* a;
+    uint64_t* d;
+    size_t size = sizeof(a);
+    if(mallctl("thread.allocatedp", &a, &size, NULL, 0) != 0
+            || mallctl("thread.deallocatedp", &d, &size, NULL, 0) != 0) {
+        return false;
+    }
+    allocated = a;
+    deallocated = d;
+    return true;
+}
+
+#else
+
+AllocatorStatistics
+allocatorStatistics(void) {
+    AllocatorStatistics s = {"malloc", 0, 0, 0, 0, 0};
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 mi = mallinfo2();
+#else
+    struct mallinfo mi = mallinfo();
+#endif
+    //uordblks counts the heap allocations, hblkhd the mmapped ones
+    s.allocated = static_cast<size_t>(mi.uordblks) + static_cast<size_t>(mi.hblkhd);
+    s.active = s.allocated;
+    s.mapped = static_cast<size_t>(mi.arena) + static_cast<size_t>(mi.hblkhd);
+#endif
+    return s;
+}
+
+bool
+allocatorBindThread(void) {
+    return false;
+}
+
+bool
+allocatorThreadCounters(const uint64_t*&, const uint64_t*&) {
+    return false;
+}
+
+#endif
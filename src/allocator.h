@@ -0,0 +1,84 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* allocator.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \brief Statistics of the memory allocator (in bytes, 0 when unknown)
+ *
+ * Built with EPS_JEMALLOC (cmake -DUSE_JEMALLOC=ON) the statistics come
+ * from jemalloc, otherwise from the glibc malloc.
+ */
+struct AllocatorStatistics {
+    /// Name of the allocator
+    const char* name;
+    /// Memory allocated by the solver
+    size_t allocated;
+    /// Memory in the pages holding allocations
+    size_t active;
+    /// Memory resident in the physical memory
+    size_t resident;
+    /// Memory mapped by the allocator
+    size_t mapped;
+    /// Number of arenas
+    unsigned int arenas;
+};
+
+/// Current statistics of the allocator
+AllocatorStatistics allocatorStatistics(void);
+
+/**
+ * \brief Give the calling thread an arena of its own
+ *
+ * Only done by jemalloc, returns false with the system allocator.
+ */
+bool allocatorBindThread(void);
+
+/**
+ * \brief Counters of the bytes allocated and freed by the calling thread
+ *
+ * The counters are updated by jemalloc on each allocation, returns false
+ * with the system allocator which does not count per thread.
+ */
+bool allocatorThreadCounters(const uint64_t*& allocated, const uint64_t*& deallocated);
+
+#endif /* __ALLOCATOR_H__ */
@@ -45,12 +45,20 @@
 #include <vector>
 #include <string>
 #include <list>
+#include <deque>
+#include <algorithm>
 #include <fstream>
 
 #include "search.h"
 #include "flatzinc.h"
 #include "stl_util.h"
 #include "lock.h"
+#include "progress.h"
+#include "affinity.h"
+#include "frontier.h"
+#include "allocator.h"
+#include "memory.h"
+#include "portfolio.h"
 
 using namespace stl_util;
 
@@ -246,9 +254,87 @@ protected:
 
         Gecode::Support::Timer _timer_problem;
 
+        /// Subproblem being solved
+        SubProblem _subproblem;
+
+        /// Progress counters of the worker (NULL if no progress report)
+        WorkerProgress* _progress;
+
+        /// NUMA node and cpu the worker is pinned on (-1 if not pinned)
+        int _node;
+        int _cpu;
+
+        /// Root space of the worker, the subproblems are cloned from it outside the lock
+        MyFlatZincSpace* _space_root;
+
+        /// Dispatches of the worker, merged in the engine statistics at the next acquisition of the lock
+        DurationStatistics _dispatch_statistics;
+
+        /// Durations of the subproblems solved by the worker (adaptive chunks)
+        DurationStatistics _problem_statistics;
+
+        /// Peak memory held by the worker
+        MemoryPeak _memory;
+
+        /// Subproblems taken at the last dispatch and not started yet (all from the same group)
+        std::deque<SubProblem> _run;
+        /// Tuples of the group of the run
+        Gecode::TupleSet* _run_tuples_bool;
+        Gecode::TupleSet* _run_tuples_int;
+        /// Group and number of subproblems of the run
+        unsigned int _run_group;
+        unsigned int _run_size;
+        /// Root space propagated with the prefix common to the run (NULL if none)
+        MyFlatZincSpace* _space_prefix;
+
+        /// Clone of the subproblem the worker restarts from (NULL if it does not restart)
+        Gecode::Space* _restart_root;
+        /// Restart sequence of the subproblem
+        Gecode::Search::Cutoff* _cutoff;
+        /// Failures after which the subproblem restarts
+        unsigned long int _restart_limit;
+
+        /// Set when another group of the portfolio won the raced subproblem
+        volatile bool _cancelled;
+
+        /// Set while the subproblem waits for its bound (deterministic mode)
+        bool _det_wait;
+        /// Set while the worker blocks on \a _det_event for the commits (lock of search held)
+        bool _det_blocked;
+        /// Signalled by the engine when the first subproblem not committed moves
+        Gecode::Support::Event _det_event;
+        /// Set when the subproblem improved its bound (deterministic mode)
+        bool _det_found;
+        /// Time waited for the bounds not committed yet in the engine statistics (in ms)
+        double _det_waited;
+        Gecode::Support::Timer _det_timer;
+
+        /// Propagate the prefix common to the subproblems of the run
+        void preparePrefix(void);
+        /// Clone the space of subproblem \a sp and post its tuples
+        MyFlatZincSpace* prepareProblem(const SubProblem& sp);
+        /// Start the next subproblem of the run
+        void dispatchProblem(void);
+        /// Constrain the subproblem just dispatched by its deterministic bound once committed, false if the engine is deleted
+        bool openProblem(void);
+        /// Restart the subproblem just dispatched when its failures reach the cutoff
+        void armRestarts(void);
+        /// Stop restarting the current subproblem
+        void disarmRestarts(void);
+        /// Solve the current subproblem again from its root
+        void restartProblem(void);
+        /// Drop the raced subproblem
+        void dropRaced(void);
+
         /// decomposeProblems
         void decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o);
 
+        /// Add the values of the first \a level decision variables of \a s to the tuples of the decomposition
+        void addLevelTuple(MyFlatZincSpace* s, unsigned int level);
+
+        /// Expand nodes of the shared frontier until the decomposition is over
+        void expandFrontier(void);
+
         /// Initialize for space \a s (of size \a sz) with engine \a e
         Worker(Gecode::Space* s, EPS_BAB& e, unsigned int id_worker);
         /// Provide access to engine
@@ -273,9 +359,21 @@ protected:
 
     enum ModeDecomposition {
         SEQUENTIAL,    //< SEQUENTIAL
-        PARALLEL       //< PARALLEL
+        PARALLEL,      //< PARALLEL
+        FRONTIER,      //< FRONTIER (recursive parallel decomposition)
+        STREAM         //< STREAM (lazy decomposition dispatched in batches)
     } _mode_decomposition;
 
+    /// Frontier shared by the workers (FRONTIER decomposition only)
+    Frontier* _frontier;
+
+    /// Lazy decomposition (STREAM decomposition only)
+    PrefixStream* _stream;
+    /// Lock of the stream, the batches are generated outside of the lock of resolution
+    Gecode::Support::Mutex m_stream;
+    /// Time spent generating the batches (in ms)
+    double _time_stream;
+
     /// space generated by parsing flatzinc file
     MyFlatZincSpace* _space_home;
 
@@ -287,17 +385,24 @@ protected:
     int _current_index_problem_decomposition;
 
     int _current_problem_resolution;
-    int _current_index_tuple_resolution;
     int _current_index_problem_resolution;
 
     int _current_problem;
 
-    int _current_index_group_tuple_resolution;
 
     std::vector<int> _groups_tuples_resolution;
     std::vector<Gecode::TupleSet*> _tuples_bool_resolution;
     std::vector<Gecode::TupleSet*> _tuples_int_resolution;
 
+    /// Subproblems in dispatch order (the first _current_problem_resolution are dispatched)
+    std::vector<SubProblem> _subproblems;
+    /// Subproblems of the batches released before _subproblems (STREAM decomposition only)
+    unsigned int _problems_base;
+    /// Subproblems of each group not solved yet
+    std::vector<unsigned int> _group_pending;
+    /// Memory of the tuples of the groups not released
+    size_t _memory_subproblems_live;
+
     std::vector<int> _problems_for_decomposition;
     int _nb_workers_decomposition_done;
 
@@ -308,13 +413,56 @@ protected:
     //Timer to compute the duration of decomposition
     Gecode::Support::Timer _timer_decomposition;
 
+    /// Progress of the search read by the reporter thread (NULL if no report)
+    ProgressMonitor* _progress;
+
+    /// Root space cloned on each NUMA node (empty if no affinity)
+    std::vector<MyFlatZincSpace*> _space_nodes;
+
+    /// Root space to clone the subproblems of the workers of \a node from
+    MyFlatZincSpace* prototype(int node);
+
+    /// Race of the branchings on the subproblems (NULL if no portfolio)
+    Portfolio* _portfolio;
+    /// Root space of each group of the portfolio
+    std::vector<MyFlatZincSpace*> _portfolio_spaces;
+
+    /// Best solution of each finished subproblem not committed yet, by id (deterministic mode)
+    std::vector<Gecode::Space*> _det_results;
+    std::vector<bool> _det_done;
+    /// First subproblem not committed
+    unsigned int _det_next;
+    /// Finished subproblems not committed
+    size_t _det_held;
+    /// Set when the engine is deleted, the workers do not wait for the commits anymore
+    bool _det_closed;
+    /// Committed incumbents with the subproblem which found them (-1 for the decomposition)
+    std::vector< std::pair<int, Gecode::Space*> > _det_bounds;
+
+    /// Bound \a b of the subproblem of \a w, blocks while the subproblems up to its id - workers() are
+    /// not all committed, false if the engine is deleted meanwhile
+    bool deterministicBound(Worker* w, Gecode::Space*& b);
+    /// Wake the workers blocked for the commits (lock of search held)
+    void wakeDeterministic(void);
+    /// Commit the subproblem finished by \a w, the incumbents are reported in subproblem order
+    void commitProblem(Worker* w);
+
+    /// Post the branchings of the portfolio on clones of the space without branchings
+    void createPortfolio(void);
+    /// Worker \a w finished its raced subproblem, false if another group won it first
+    bool winRaced(Worker* w);
+
     unsigned int getBusyWorkers() {
         return this->n_busy;
     }
 
+    /// Contention of the engine locks (owned by the root space if any)
+    EngineLockStatistics* _lock_statistics;
+    EngineLockStatistics _lock_statistics_engine;
+
     Gecode::Support::Mutex m_findjob_resolution;
     void lockFindJobResolution() {
-        m_findjob_resolution.acquire();
+        _lock_statistics->findjob_resolution.acquire(m_findjob_resolution);
     }
 
     void unlockFindJobResolution() {
@@ -323,15 +471,218 @@ protected:
 
     Gecode::Support::Mutex m_findjob_decomposition;
     void lockFindJobDecomposition() {
-        m_findjob_decomposition.acquire();
+        _lock_statistics->findjob_decomposition.acquire(m_findjob_decomposition);
     }
 
     void unlockFindJobDecomposition() {
         m_findjob_decomposition.release();
     }
 
-    void notifyFinishedSubproblem(unsigned int id_worker, double time_problem) {
+    void notifyFinishedSubproblem(unsigned int id_worker, const SubProblem& sp, double time_problem) {
         (*_space_home->_time_subproblems_workers)[id_worker].push_back(static_cast<unsigned int>(floor(time_problem)));
+        if(_space_home->_trace_subproblems_workers) {
+            (*_space_home->_trace_subproblems_workers)[id_worker].push_back(SubProblemTrace(sp.id, sp.hardness, static_cast<unsigned int>(floor(time_problem))));
+        }
+    }
+
+    /// Clone of the incumbent, NULL if there is none yet (the hardness probes are bounded by it)
+    Gecode::Space* incumbent(void) {
+        _lock_statistics->search.acquire(m_search);
+        Gecode::Space* b = best ? best->clone(false) : NULL;
+        m_search.release();
+        return b;
+    }
+
+    /// Group the leaves of the complete frontier in \a groups with their estimated \a hardness (lock of resolution not held)
+    void groupFrontier(std::vector<FrontierGroup>& groups, std::vector< std::vector<double> >& hardness) {
+        _frontier->groups(_space_home->_space_hook->bv.size(), groups);
+        hardness.resize(groups.size());
+        if(optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+            //The other workers are done with the hook, only the caller clones it
+            Gecode::Space* b = incumbent();
+            for(size_t i = 0; i < groups.size(); i++) {
+                std::vector<int> group_tuples(groups[i].size, 1);
+                estimateHardness(_space_home->_space_hook, group_tuples,
+                                 groups[i].tuples_bool, groups[i].tuples_int, optSearch.probe_nodes, hardness[i], b);
+            }
+            delete b;
+        }
+    }
+
+    /// Append the \a groups of leaves of the frontier as subproblems, through the tuples of \a w (lock of resolution held)
+    void addFrontier(Worker* w, const std::vector<FrontierGroup>& groups, const std::vector< std::vector<double> >& hardness) {
+        for(size_t i = 0; i < groups.size(); i++) {
+            w->_tuples_bool_ndi = new Gecode::TupleSet(groups[i].tuples_bool);
+            w->_tuples_int_ndi = new Gecode::TupleSet(groups[i].tuples_int);
+            w->_group_tuples.assign(groups[i].size, 1);
+
+            addProblems(w, hardness[i]);
+
+            delete w->_tuples_bool_ndi;
+            w->_tuples_bool_ndi = NULL;
+            delete w->_tuples_int_ndi;
+            w->_tuples_int_ndi = NULL;
+            w->_group_tuples.clear();
+        }
+
+        _space_home->_nodes_decomposition = _frontier->nodes();
+        _space_home->_fails_decomposition = _frontier->fails();
+        _space_home->_depth_decomposition = _frontier->depth();
+        _space_home->_memory_decomposition += _frontier->memory();
+        if(_frontier->limited()) {
+            _space_home->_memory_limited++;
+        }
+        _space_home->_problems = _groups_tuples_resolution.size();
+    }
+
+    /// Release \a n solved subproblems of \a group, a streamed group is freed with its last one (lock of resolution held)
+    void releaseProblems(unsigned int group, unsigned int n) {
+        _group_pending[group] -= n;
+        if(_mode_decomposition == STREAM && _group_pending[group] == 0) {
+            _memory_subproblems_live -= tupleSetMemory(*_tuples_bool_resolution[group])
+                                        + tupleSetMemory(*_tuples_int_resolution[group]);
+            delete _tuples_bool_resolution[group];
+            _tuples_bool_resolution[group] = NULL;
+            delete _tuples_int_resolution[group];
+            _tuples_int_resolution[group] = NULL;
+        }
+    }
+
+    /// Append the next batch of the stream as subproblems, through the tuples of \a w (lock of resolution not held)
+    void refillStream(Worker* w) {
+        m_stream.acquire();
+
+        //Another worker may have refilled meanwhile
+        lockFindJobResolution();
+        bool generate = _current_problem_resolution == static_cast<int>(_subproblems.size())
+                        && _nb_workers_decomposition_done < static_cast<int>(workers());
+        if(generate) {
+            //Every subproblem is dispatched, only the groups still solved are kept
+            _problems_base += _subproblems.size();
+            _subproblems.clear();
+            _groups_tuples_resolution.clear();
+            _current_problem_resolution = 0;
+        }
+        unlockFindJobResolution();
+
+        if(!generate) {
+            m_stream.release();
+            return;
+        }
+
+        Gecode::Support::Timer t;
+        t.start();
+
+        std::vector<FrontierGroup> groups;
+        _stream->batch(optSearch.stream_batch, _space_home->_space_hook->bv.size(), groups);
+
+        std::vector< std::vector<double> > hardness(groups.size());
+        if(optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+            Gecode::Space* b = incumbent();
+            for(size_t i = 0; i < groups.size(); i++) {
+                std::vector<int> group_tuples(groups[i].size, 1);
+                estimateHardness(_space_home->_space_hook, group_tuples,
+                                 groups[i].tuples_bool, groups[i].tuples_int, optSearch.probe_nodes, hardness[i], b);
+            }
+            delete b;
+        }
+
+        lockFindJobResolution();
+        for(size_t i = 0; i < groups.size(); i++) {
+            w->_tuples_bool_ndi = new Gecode::TupleSet(groups[i].tuples_bool);
+            w->_tuples_int_ndi = new Gecode::TupleSet(groups[i].tuples_int);
+            w->_group_tuples.assign(groups[i].size, 1);
+
+            addProblems(w, hardness[i]);
+
+            delete w->_tuples_bool_ndi;
+            w->_tuples_bool_ndi = NULL;
+            delete w->_tuples_int_ndi;
+            w->_tuples_int_ndi = NULL;
+            w->_group_tuples.clear();
+        }
+
+        _time_stream += t.stop();
+        _space_home->_time_decomposition = static_cast<unsigned int>(floor(_time_stream));
+        _space_home->_problems = _problems_base + _groups_tuples_resolution.size();
+        if(_progress) {
+            _progress->problems = _space_home->_problems;
+        }
+
+        if(_stream->done()) {
+            _space_home->_nodes_decomposition = _stream->nodes();
+            _space_home->_fails_decomposition = _stream->fails();
+            _space_home->_depth_decomposition = _stream->depth();
+            _space_home->_memory_decomposition = _stream->memory();
+            _nb_workers_decomposition_done = workers();
+            if(_progress) {
+                _progress->decomposed = true;
+            }
+        }
+        unlockFindJobResolution();
+
+        m_stream.release();
+    }
+
+    /// Number of subproblems to hand to \a w at once (lock of resolution held)
+    unsigned int chunkSize(const Worker* w) const {
+        unsigned int left = _subproblems.size() - _current_problem_resolution;
+        //Guided chunks keep enough subproblems for every worker to balance the end of the search
+        unsigned int guided = left / (2 * workers());
+        unsigned int size = optSearch.chunk_size;
+        switch(optSearch.chunk) {
+        case MyFlatZincOptions::CHUNK_GUIDED:
+            size = std::max(size, guided);
+            break;
+        case MyFlatZincOptions::CHUNK_ADAPTIVE:
+            if(w->_problem_statistics.count) {
+                double average = std::max(w->_problem_statistics.average(), 0.001);
+                unsigned int adaptive = static_cast<unsigned int>(optSearch.chunk_time / average);
+                size = std::max(size, std::min(adaptive, guided));
+            }
+            break;
+        default:
+            break;
+        }
+        return std::max(size, 1u);
+    }
+
+    /// Append the subproblems decomposed by \a w with their estimated \a hardness (lock of resolution held)
+    void addProblems(Worker* w, const std::vector<double>& hardness) {
+        unsigned int group = _tuples_bool_resolution.size();
+        unsigned int first_tuple = 0;
+        size_t batch = _subproblems.size();
+        for(size_t i = 0; i < w->_group_tuples.size(); i++) {
+            _subproblems.push_back(SubProblem(_problems_base + _subproblems.size(), group, first_tuple, w->_group_tuples[i],
+                                              i < hardness.size() ? hardness[i] : 0.0));
+            first_tuple += w->_group_tuples[i];
+        }
+
+        _groups_tuples_resolution.insert(_groups_tuples_resolution.end(), w->_group_tuples.begin(), w->_group_tuples.end());
+        _tuples_bool_resolution.push_back(new Gecode::TupleSet(*w->_tuples_bool_ndi));
+        _tuples_int_resolution.push_back(new Gecode::TupleSet(*w->_tuples_int_ndi));
+
+        if(!_tuples_bool_resolution.back()->finalized()) {
+            _tuples_bool_resolution.back()->finalize();
+        }
+
+        if(!_tuples_int_resolution.back()->finalized()) {
+            _tuples_int_resolution.back()->finalize();
+        }
+
+        _group_pending.push_back(w->_group_tuples.size());
+        _memory_subproblems_live += tupleSetMemory(*_tuples_bool_resolution.back())
+                                    + tupleSetMemory(*_tuples_int_resolution.back());
+        _space_home->_memory_subproblems = std::max(_space_home->_memory_subproblems, _memory_subproblems_live);
+
+        //Longest processing time first among the subproblems not dispatched yet, which are
+        //already sorted: only the batch is sorted, then merged after the pending ones of equal
+        //hardness. The groups of a portfolio go through the subproblems in the same order
+        if(optSearch.order == MyFlatZincOptions::ORDER_LPT && !_portfolio) {
+            std::stable_sort(_subproblems.begin() + batch, _subproblems.end(), HarderSubProblem());
+            std::inplace_merge(_subproblems.begin() + _current_problem_resolution, _subproblems.begin() + batch,
+                               _subproblems.end(), HarderSubProblem());
+        }
     }
 
 public:
@@ -420,7 +771,24 @@ EPS_BAB::Worker::Worker(Gecode::Space* s, EPS_BAB& e, unsigned int id_worker)
       mode_search(DECOMPOSITION),
       id(id_worker),
       _tuples_bool_ndi(NULL),
-      _tuples_int_ndi(NULL) {
+      _tuples_int_ndi(NULL),
+      _progress(NULL),
+      _node(-1),
+      _cpu(-1),
+      _space_root(NULL),
+      _run_tuples_bool(NULL),
+      _run_tuples_int(NULL),
+      _run_group(0),
+      _run_size(0),
+      _space_prefix(NULL),
+      _restart_root(NULL),
+      _cutoff(NULL),
+      _restart_limit(0),
+      _cancelled(false),
+      _det_wait(false),
+      _det_blocked(false),
+      _det_found(false),
+      _det_waited(0.0) {
     idle = true;
 }
 
@@ -434,19 +802,41 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
       _current_index_problem_decomposition(0),
       _current_problem_resolution(0),
       _current_problem(0),
-      _current_index_tuple_resolution(0),
       _current_index_problem_resolution(0),
-      _current_index_group_tuple_resolution(0),
       _nb_workers_decomposition_done(0),
-      _mode_decomposition(PARALLEL), optSearch(o) {
+      _mode_decomposition(PARALLEL),
+      _frontier(NULL),
+      _stream(NULL),
+      _time_stream(0.0),
+      optSearch(o),
+      _problems_base(0),
+      _memory_subproblems_live(0),
+      _progress(NULL),
+      _portfolio(NULL),
+      _det_next(0),
+      _det_held(0),
+      _det_closed(false) {
 
     _workers = NULL;
     _master = new Worker(NULL,*this, -1);
 
+    _lock_statistics = _space_home->_lock_statistics ? _space_home->_lock_statistics : &_lock_statistics_engine;
+
+    //Report the progress from the decomposition on
+    if(o.progress_interval > 0) {
+        _progress = new ProgressMonitor(workers());
+        _progress->start(o.progress_interval, o.progress_file);
+    }
+
     //Start Timer
     _timer_decomposition.start();
 
-    if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::DBDFSwP
+    if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::SDBDFS) {
+        _mode_decomposition = STREAM;
+    } else if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::RDBDFSwP
+            && optSearch.threads > 1) {
+        _mode_decomposition = FRONTIER;
+    } else if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::DBDFSwP
             && optSearch.threads > 1) {
         _mode_decomposition = PARALLEL;
     } else {
@@ -456,23 +846,37 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
     //Force sequential
     //_mode_decomposition = SEQUENTIAL;
 
-    if(_mode_decomposition == SEQUENTIAL) {
-        optSearch.nb_problems = o.nb_problems;
-    } else {
+    if(_mode_decomposition == PARALLEL) {
         optSearch.nb_problems = o.threads;
+    } else {
+        optSearch.nb_problems = o.nb_problems;
     }
 
     _space_home->_space_hook->_nodes_decomposition = 0;
     _space_home->_space_hook->_fails_decomposition = 0;
     _space_home->_space_hook->_memory_decomposition = 0;
     _space_home->_space_hook->_iterations_decomposition = 0;
+    _space_home->_space_hook->_memory_limited = 0;
     _space_home->_space_hook->_depth_decomposition = 0;
+    _space_home->_memory_subproblems = 0;
+
+    //Measured while no worker allocates
+    _space_home->_memory_space = spaceMemory(_space_home->_space_hook);
 
     _master->done = false;
     //Gecode::Support::Timer t_solve;
     //t_solve.start();
 
-    _master->decomposeProblems(_space_home->_space_hook, optSearch);
+    if(_mode_decomposition == FRONTIER) {
+        //The workers expand the decomposition from the root
+        _frontier = new Frontier(optSearch.nb_problems, optSearch.memory_budget);
+    } else if(_mode_decomposition == STREAM) {
+        //The workers generate the subproblems by batches when they run out of them
+        _stream = new PrefixStream(static_cast<MyFlatZincSpace*>(_space_home->_space_hook->clone(false)),
+                                   optSearch.nb_problems);
+    } else {
+        _master->decomposeProblems(_space_home->_space_hook, optSearch);
+    }
 
     unsigned int time_solve = static_cast<unsigned int>(floor(this->_timer_decomposition.stop()));
     //std::cerr << "Time resolution : " << time_solve << std::endl;
@@ -492,16 +896,21 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
         _nb_workers_decomposition_done = workers();
 
         if(!_master->_group_tuples.empty()) {
-            _groups_tuples_resolution.insert(_groups_tuples_resolution.end(), _master->_group_tuples.begin(), _master->_group_tuples.end());
-            _tuples_bool_resolution.push_back(new Gecode::TupleSet(*_master->_tuples_bool_ndi));
-            _tuples_int_resolution.push_back(new Gecode::TupleSet(*_master->_tuples_int_ndi));
-
-            if(!_tuples_bool_resolution.back()->finalized()) {
-                _tuples_bool_resolution.back()->finalize();
+            std::vector<double> hardness;
+            if(optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+                //The incumbent of the decomposition bounds the probes
+                estimateHardness(_space_home->_space_hook, _master->_group_tuples,
+                                 *_master->_tuples_bool_ndi, *_master->_tuples_int_ndi, optSearch.probe_nodes, hardness, best);
             }
+            addProblems(_master, hardness);
+        }
 
-            if(!_tuples_int_resolution.back()->finalized()) {
-                _tuples_int_resolution.back()->finalize();
+        if(optSearch.deterministic) {
+            //The subproblems are committed in generation order, from the incumbent of the decomposition
+            _det_results.assign(_subproblems.size(), NULL);
+            _det_done.assign(_subproblems.size(), false);
+            if(best) {
+                _det_bounds.push_back(std::make_pair(-1, best->clone(false)));
             }
         }
 
@@ -527,16 +936,22 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
     _space_home->_fails_decomposition = _space_home->_space_hook->_fails_decomposition;
     _space_home->_memory_decomposition = _space_home->_space_hook->_memory_decomposition;
     _space_home->_iterations_decomposition = _space_home->_space_hook->_iterations_decomposition;
+    _space_home->_memory_limited = _space_home->_space_hook->_memory_limited;
     _space_home->_depth_decomposition = _space_home->_space_hook->_depth_decomposition;
 
 
     _space_home->_problems = _groups_tuples_resolution.size();
 
+    if(_progress) {
+        _progress->problems = _space_home->_problems;
+        _progress->decomposed = (_mode_decomposition == SEQUENTIAL);
+    }
+
     _space_home->_time_max_inactivity = 0;
     _already_timer_max_inactivity_started = false;
 
     //in case of _mode_decomposition
-    if(_master->_group_tuples.empty() && _space_home->_problems == 0) {
+    if(_mode_decomposition != FRONTIER && _mode_decomposition != STREAM && _master->_group_tuples.empty() && _space_home->_problems == 0) {
         n_busy = 0;
         std::cerr << "Problem resolved in sequential dbdfs decomposition !!!\n";
         return;
@@ -547,6 +962,14 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
     _space_home->status(sstat);
     _space_home->_space_hook->status(sstat);
     */
+    //Place the workers on the cpus, each node gets its own copy of the root space
+    Topology topology;
+    if(optSearch.affinity != MyFlatZincOptions::AFFINITY_NONE) {
+        _space_nodes.resize(topology.nodes(), NULL);
+    }
+
+    createPortfolio();
+
     // Create workers
     _workers = static_cast<Worker**>
                (Gecode::heap.ralloc(workers() * sizeof(Worker*)));
@@ -555,12 +978,19 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
     for (unsigned int i=0; i<workers(); i++) {
         _workers[i] = new Worker(NULL,*this, i); //NULL permit the workers to find a space
         _workers[i]->done = false;
+        if(_progress) {
+            _workers[i]->_progress = &_progress->worker(i);
+        }
+        if(optSearch.affinity != MyFlatZincOptions::AFFINITY_NONE) {
+            topology.place(i, optSearch.affinity == MyFlatZincOptions::AFFINITY_SCATTER,
+                           _workers[i]->_node, _workers[i]->_cpu);
+        }
         /*
         if(best) {
             _workers[i]->best = best->clone(false);
         }
         */
-        if(_mode_decomposition == SEQUENTIAL) {
+        if(_mode_decomposition == SEQUENTIAL || _mode_decomposition == STREAM) {
             _workers[i]->mode_search = Worker::RESOLUTION;
         } else {
             _workers[i]->mode_search = Worker::DECOMPOSITION;
@@ -570,6 +1000,13 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
     //Resize time_subproblems resolved by workers
     _space_home->_time_subproblems_workers->clear();
     _space_home->_time_subproblems_workers->resize(workers());
+    if(_space_home->_memory_workers) {
+        _space_home->_memory_workers->assign(workers(), 0);
+    }
+    if(_space_home->_trace_subproblems_workers) {
+        _space_home->_trace_subproblems_workers->clear();
+        _space_home->_trace_subproblems_workers->resize(workers());
+    }
 
     // Block all workers
     block();
@@ -581,6 +1018,7 @@ EPS_BAB::EPS_BAB(Gecode::Space* s, const MySearchOptions& o)
 forceinline void
 EPS_BAB::Worker::reset(Gecode::Space* s) {
     delete cur;
+    disarmRestarts();
     delete best;
     best = NULL;
     path.reset(0);
@@ -678,7 +1116,7 @@ EPS_BAB::notifyBestSolution(int valueObj, Gecode::FlatZinc::FlatZincSpace::Meth
 
 forceinline void
 EPS_BAB::solution(Worker* w) {
-    m_search.acquire();
+    _lock_statistics->search.acquire(m_search);
 
     if (w) {
         if(w->best) {
@@ -761,6 +1199,13 @@ EPS_BAB::solution(Worker* w) {
     std::cerr << "new objective: " << static_cast<MyFlatZincSpace*>(best)->iv[static_cast<MyFlatZincSpace*>(best)->optVar()].val() << std::endl;
 #endif
 
+    if(_progress) {
+        MyFlatZincSpace* fz = static_cast<MyFlatZincSpace*>(best);
+        _progress->incumbent = fz->iv[fz->optVar()].val();
+        _progress->has_incumbent = true;
+        _progress->solutions++;
+    }
+
     bool bs = signal();
     solutions.push(best->clone());
     if (bs) {
@@ -771,6 +1216,370 @@ EPS_BAB::solution(Worker* w) {
 
 }
 
+bool
+EPS_BAB::deterministicBound(Worker* w, Gecode::Space*& b) {
+    //Lag of workers() subproblems, the worker of k does not wait for the ones solved beside it
+    unsigned int k = w->_subproblem.id;
+    unsigned int lag = workers();
+    _lock_statistics->search.acquire(m_search);
+    while(_det_next + lag <= k) {
+        if(_det_closed) {
+            m_search.release();
+            return false;
+        }
+        //Woken by the commits, taking the lock again is not a new acquisition of the statistics
+        w->_det_blocked = true;
+        m_search.release();
+        w->_det_event.wait();
+        m_search.acquire();
+    }
+    b = NULL;
+    for(size_t i = _det_bounds.size(); i--; ) {
+        int j = _det_bounds[i].first;
+        if(j < 0 || static_cast<unsigned int>(j) + lag <= k) {
+            b = _det_bounds[i].second->clone(false);
+            break;
+        }
+    }
+    m_search.release();
+    return true;
+}
+
+void
+EPS_BAB::commitProblem(Worker* w) {
+    _lock_statistics->search.acquire(m_search);
+
+    unsigned int k = w->_subproblem.id;
+    _det_results[k] = w->_det_found ? w->best->clone(false) : NULL;
+    _det_done[k] = true;
+    _det_held++;
+    _space_home->_deterministic_held = std::max(_space_home->_deterministic_held, _det_held);
+    _space_home->_time_deterministic_wait += w->_det_waited;
+    w->_det_waited = 0.0;
+
+    bool bs = false;
+    unsigned int first = _det_next;
+    while(_det_next < _det_done.size() && _det_done[_det_next]) {
+        Gecode::Space* r = _det_results[_det_next];
+        _det_results[_det_next] = NULL;
+        if(r && (!best || ProblemCompare(true)(static_cast<MyFlatZincSpace*>(r), static_cast<MyFlatZincSpace*>(best)))) {
+            delete best;
+            best = r;
+            _det_bounds.push_back(std::make_pair(static_cast<int>(_det_next), best->clone(false)));
+
+            if(_progress) {
+                MyFlatZincSpace* fz = static_cast<MyFlatZincSpace*>(best);
+                _progress->incumbent = fz->iv[fz->optVar()].val();
+                _progress->has_incumbent = true;
+                _progress->solutions++;
+            }
+
+            bs = bs || signal();
+            solutions.push(best->clone());
+        } else {
+            delete r;
+        }
+        _det_held--;
+        _det_next++;
+    }
+    if(_det_next != first) {
+        wakeDeterministic();
+    }
+    if (bs) {
+        e_search.signal();
+    }
+
+    m_search.release();
+}
+
+void
+EPS_BAB::wakeDeterministic(void) {
+    for(unsigned int i = 0; i < workers(); i++) {
+        Worker* w = worker(i);
+        if(w->_det_blocked) {
+            w->_det_blocked = false;
+            w->_det_event.signal();
+        }
+    }
+}
+
+
+/*
+ * Worker: preparing the subproblems
+ */
+void
+EPS_BAB::Worker::preparePrefix(void) {
+    delete _space_prefix;
+    _space_prefix = NULL;
+
+    if(_run.size() < 2) {
+        return;
+    }
+
+    //Length of the prefix shared by all the tuples of the run (bool variables first),
+    //the subproblems of the run are not contiguous when they are ordered by hardness
+    Gecode::TupleSet& bool_tuples = *_run_tuples_bool;
+    Gecode::TupleSet& int_tuples = *_run_tuples_int;
+    int arity_bool = bool_tuples.tuples() ? bool_tuples.arity() : 0;
+    int arity_int = int_tuples.tuples() ? int_tuples.arity() : 0;
+    unsigned int index_tuple_first = _run.front().first_tuple;
+
+    int prefix_bool = arity_bool;
+    int prefix_int = arity_int;
+    for(size_t k = 0; k < _run.size() && prefix_bool + prefix_int > 0; k++) {
+        for(unsigned int i = _run[k].first_tuple; i < _run[k].first_tuple + _run[k].nb_tuples; i++) {
+            int j = 0;
+            while(j < prefix_bool && bool_tuples[i][j] == bool_tuples[index_tuple_first][j]) {
+                j++;
+            }
+            prefix_bool = j;
+            if(prefix_bool < arity_bool) {
+                prefix_int = 0;
+            }
+            j = 0;
+            while(j < prefix_int && int_tuples[i][j] == int_tuples[index_tuple_first][j]) {
+                j++;
+            }
+            prefix_int = j;
+        }
+    }
+
+    if(prefix_bool + prefix_int == 0) {
+        return;
+    }
+
+    MyFlatZincSpace* space_prefix = static_cast<MyFlatZincSpace*>(_space_root->clone(false));
+    for(int j = 0; j < prefix_bool; j++) {
+        Gecode::rel(*space_prefix, space_prefix->bv[j], Gecode::IRT_EQ, bool_tuples[index_tuple_first][j]);
+    }
+    for(int j = 0; j < prefix_int; j++) {
+        Gecode::rel(*space_prefix, space_prefix->iv[j], Gecode::IRT_EQ, int_tuples[index_tuple_first][j]);
+    }
+
+    //A failed prefix fails every subproblem of the run, they are then solved from the root
+    if(space_prefix->status() == Gecode::SS_FAILED) {
+        delete space_prefix;
+        return;
+    }
+    _space_prefix = space_prefix;
+}
+
+MyFlatZincSpace*
+EPS_BAB::Worker::prepareProblem(const SubProblem& sp) {
+    MyFlatZincSpace* space_resolution = static_cast<MyFlatZincSpace*>((_space_prefix ? _space_prefix : _space_root)->clone(false)); //cloning for independant worker
+
+    //Same posting as the hardness estimates of the subproblems
+    postSubProblem(space_resolution, *_run_tuples_bool, *_run_tuples_int, sp.first_tuple, sp.first_tuple + sp.nb_tuples);
+
+    return space_resolution;
+}
+
+void
+EPS_BAB::Worker::dispatchProblem(void) {
+    _subproblem = _run.front();
+    _run.pop_front();
+
+    if(cur) {
+        delete cur;
+    }
+
+    cur = prepareProblem(_subproblem);
+
+    if(engine().optSearch.deterministic) {
+        //The bound depends on the commits, not on the timing of the other workers
+        _dispatch_statistics.add(_timer_problem.stop());
+        _det_wait = true;
+        _det_timer.start();
+        return;
+    }
+
+    if (best) {
+        cur->constrain(*best);
+    }
+
+    //_timer_problem was started when the subproblem was taken
+    _dispatch_statistics.add(_timer_problem.stop());
+
+    armRestarts();
+}
+
+bool
+EPS_BAB::Worker::openProblem(void) {
+    Gecode::Space* b = NULL;
+    if(!engine().deterministicBound(this, b)) {
+        return false;
+    }
+    _det_waited += _det_timer.stop();
+    _det_wait = false;
+    _det_found = false;
+
+    delete best;
+    best = b;
+    if (best) {
+        cur->constrain(*best);
+    }
+
+    armRestarts();
+    return true;
+}
+
+void
+EPS_BAB::Worker::armRestarts(void) {
+    disarmRestarts();
+    _cutoff = createWorkerCutoff(engine().optSearch);
+    if(_cutoff == NULL || cur->status(*this) == Gecode::SS_FAILED) {
+        disarmRestarts();
+        return;
+    }
+    _restart_root = cur->clone();
+    _restart_limit = fail + (*_cutoff)();
+    //Depth limit of the nogoods posted at the restarts, 0 if they are disabled
+    path.ngdl(static_cast<int>(engine().opt().nogoods_limit));
+}
+
+void
+EPS_BAB::Worker::disarmRestarts(void) {
+    delete _restart_root;
+    _restart_root = NULL;
+    delete _cutoff;
+    _cutoff = NULL;
+}
+
+void
+EPS_BAB::Worker::restartProblem(void) {
+    delete cur;
+    cur = NULL;
+    if(path.ngdl() > 0) {
+        //The subtrees already refuted are not explored again. The nogoods are
+        //only valid below the root of the subproblem, they are not shared
+        path.post(*_restart_root);
+        nogood += path.ng();
+        if(_restart_root->status(*this) == Gecode::SS_FAILED) {
+            //The nogoods refute the whole subproblem
+            path.reset(0);
+            disarmRestarts();
+            return;
+        }
+    }
+    path.reset(0);
+    d = mark = 0;
+    restart++;
+    //AFC and activity are shared by all the clones, the branchings keep what they learnt
+    cur = _restart_root->clone();
+    //The restart keeps the incumbent
+    if (best) {
+        cur->constrain(*best);
+    }
+    _restart_limit = fail + (*_cutoff)();
+    path.ngdl(static_cast<int>(engine().opt().nogoods_limit));
+}
+
+/*
+ * Worker: portfolio
+ */
+void
+EPS_BAB::Worker::dropRaced(void) {
+    engine().lockFindJobResolution();
+    engine()._portfolio->drop(this->id);
+    engine().unlockFindJobResolution();
+}
+
+void
+EPS_BAB::createPortfolio(void) {
+    //The streamed subproblems are dropped once dispatched, they cannot be raced
+    if(optSearch.portfolio.empty() || _mode_decomposition == STREAM
+            || optSearch.mode_search == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_GENERATION) {
+        return;
+    }
+    Portfolio* portfolio = new Portfolio(optSearch.portfolio, workers());
+    for(unsigned int g = 0; g < portfolio->groups(); g++) {
+        MyFlatZincSpace* s = static_cast<MyFlatZincSpace*>(_space_home->_space_hook->clone(false));
+        if(!s->createBranchers(portfolio->branching(g))) {
+            std::cerr << "Portfolio ignored, the model has no branching variants\n";
+            delete s;
+            delete portfolio;
+            STLDeleteElements(&_portfolio_spaces);
+            return;
+        }
+        (void) s->status();
+        _portfolio_spaces.push_back(s);
+    }
+    _portfolio = portfolio;
+}
+
+bool
+EPS_BAB::winRaced(Worker* w) {
+    std::vector<unsigned int> losers;
+    lockFindJobResolution();
+    bool won = _portfolio->finish(w->id, losers);
+    for(size_t i = 0; i < losers.size(); i++) {
+        _workers[losers[i]]->_cancelled = true;
+    }
+    if(won && _space_home->_portfolio_wins) {
+        (*_space_home->_portfolio_wins)[_portfolio->group(w->id)]++;
+    }
+    unlockFindJobResolution();
+    return won;
+}
+
+/*
+ * Worker: recursive parallel decomposition
+ */
+void
+EPS_BAB::Worker::expandFrontier(void) {
+    //Lock this instruction because concurrent access to space hook must be protected
+    engine().lockFindJobDecomposition();
+    MyFlatZincSpace* space_for_decomposition = static_cast<MyFlatZincSpace*>(engine()._space_home->_space_hook->clone(false));
+    engine().unlockFindJobDecomposition();
+
+    Frontier& frontier = *engine()._frontier;
+    Prefix p;
+    std::vector<Prefix> children;
+    MemoryPeak memory;
+    memory.start();
+    while(frontier.pop(p)) {
+        ExpandStatus status = expandPrefix(space_for_decomposition, p, children);
+        frontier.push(p, status, children);
+        //The root of the worker and the clone of the expanded node
+        memory.sample(2 * engine()._space_home->_memory_space);
+    }
+
+    delete space_for_decomposition;
+
+    engine().lockFindJobResolution();
+
+    engine()._space_home->_memory_decomposition += memory.peak();
+
+    //The last worker publishes the subproblems, the others wait for them in find
+    if(engine()._nb_workers_decomposition_done + 1 < static_cast<int>(engine().workers())) {
+        engine()._nb_workers_decomposition_done++;
+        engine().unlockFindJobResolution();
+        return;
+    }
+
+    engine().unlockFindJobResolution();
+
+    //The frontier is complete, its leaves are probed outside of the lock
+    std::vector<FrontierGroup> groups;
+    std::vector< std::vector<double> > hardness;
+    engine().groupFrontier(groups, hardness);
+
+    engine().lockFindJobResolution();
+
+    engine().addFrontier(this, groups, hardness);
+    engine()._nb_workers_decomposition_done++;
+    engine()._space_home->_time_decomposition = static_cast<unsigned int>(floor(engine()._timer_decomposition.stop()));
+#ifdef _DEBUG
+    fprintf(stderr, "Decomposition of the frontier done => %d problems generated\n", engine()._space_home->_problems);
+#endif
+
+    if(engine()._progress) {
+        engine()._progress->problems = engine()._space_home->_problems;
+        engine()._progress->decomposed = true;
+    }
+
+    engine().unlockFindJobResolution();
+}
 
 /*
  * Worker: finding and stealing working
@@ -778,6 +1587,10 @@ EPS_BAB::solution(Worker* w) {
 forceinline void
 EPS_BAB::Worker::find(void) {
 
+    if(mode_search == DECOMPOSITION && engine()._mode_decomposition == FRONTIER) {
+        expandFrontier();
+        mode_search = RESOLUTION;
+    }
 
     if(mode_search == DECOMPOSITION) {
 
@@ -852,35 +1665,38 @@ EPS_BAB::Worker::find(void) {
         //std::cerr << this->id << "\n";
         //std::cerr << engine()._problems_to_generate_worker.size() << "\n";
         opt.nb_problems = engine()._problems_for_decomposition[this->id];
+        //The workers decompose at the same time, each one gets a share of the budget
+        opt.memory_budget = engine().optSearch.memory_budget / engine().workers();
 
         space_for_decomposition->_nodes_decomposition = 0;
         space_for_decomposition->_fails_decomposition = 0;
         space_for_decomposition->_memory_decomposition = 0;
         space_for_decomposition->_iterations_decomposition = 0;
+        space_for_decomposition->_memory_limited = 0;
         space_for_decomposition->_depth_decomposition = 0;
 
         this->decomposeProblems(space_for_decomposition, opt);
 
+        //Estimate the hardness on the private space, outside of the lock
+        std::vector<double> hardness;
+        if(_group_tuples.size() && engine().optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+            Gecode::Space* b = engine().incumbent();
+            estimateHardness(space_for_decomposition, _group_tuples, *_tuples_bool_ndi, *_tuples_int_ndi,
+                             engine().optSearch.probe_nodes, hardness, b);
+            delete b;
+        }
+
         engine().lockFindJobResolution();
 
         if(_group_tuples.size()) {
 
-            engine()._groups_tuples_resolution.insert(engine()._groups_tuples_resolution.end(), _group_tuples.begin(), _group_tuples.end());
-            engine()._tuples_bool_resolution.push_back(new Gecode::TupleSet(*_tuples_bool_ndi));
-            engine()._tuples_int_resolution.push_back(new Gecode::TupleSet(*_tuples_int_ndi));
-
-            if(!engine()._tuples_bool_resolution.back()->finalized()) {
-                engine()._tuples_bool_resolution.back()->finalize();
-            }
-
-            if(!engine()._tuples_int_resolution.back()->finalized()) {
-                engine()._tuples_int_resolution.back()->finalize();
-            }
+            engine().addProblems(this, hardness);
 
             engine()._space_home->_nodes_decomposition += space_for_decomposition->_nodes_decomposition;
             engine()._space_home->_fails_decomposition += space_for_decomposition->_fails_decomposition;
             engine()._space_home->_memory_decomposition += space_for_decomposition->_memory_decomposition;
             engine()._space_home->_iterations_decomposition += space_for_decomposition->_iterations_decomposition;
+            engine()._space_home->_memory_limited += space_for_decomposition->_memory_limited;
 
             if(engine()._space_home->_depth_decomposition < space_for_decomposition->_depth_decomposition) {
                 engine()._space_home->_depth_decomposition = space_for_decomposition->_depth_decomposition;
@@ -891,6 +1707,11 @@ EPS_BAB::Worker::find(void) {
 
         engine()._nb_workers_decomposition_done++;
 
+        if(engine()._progress) {
+            engine()._progress->problems = engine()._space_home->_problems;
+            engine()._progress->decomposed = (engine()._nb_workers_decomposition_done == engine().workers());
+        }
+
 #ifdef _DEBUG
         if(_group_tuples.size()) {
             fprintf(stderr, "Decomposition by worker %d done => %d problems generated\n", this->id, _group_tuples.size());
@@ -919,9 +1740,70 @@ EPS_BAB::Worker::find(void) {
         mode_search = RESOLUTION;
     }
 
+    //Next subproblem of the run taken at the last dispatch
+    if(!_run.empty()) {
+        _timer_problem.start();
+        idle = false;
+        mark = d = 0;
+        dispatchProblem();
+        return;
+    }
+
     engine().lockFindJobResolution();
 
-    if(engine()._current_problem_resolution < engine()._groups_tuples_resolution.size()) {
+    engine()._lock_statistics->dispatch.merge(_dispatch_statistics);
+    _dispatch_statistics = DurationStatistics();
+
+    //The last run is solved
+    if(_run_tuples_bool) {
+        engine().releaseProblems(_run_group, _run_size);
+        _run_tuples_bool = NULL;
+        _run_tuples_int = NULL;
+    }
+
+    //Out of subproblems, generate the next batch of the stream
+    if(engine()._mode_decomposition == STREAM
+            && engine()._current_problem_resolution == static_cast<int>(engine()._subproblems.size())
+            && engine()._nb_workers_decomposition_done < static_cast<int>(engine().workers())) {
+        engine().unlockFindJobResolution();
+        engine().refillStream(this);
+        engine().lockFindJobResolution();
+    }
+
+    //Race the next subproblem with the branching of the group of the worker
+    int raced = -1;
+    if(engine()._portfolio) {
+        raced = engine()._portfolio->take(this->id, engine()._subproblems.size());
+    }
+
+    if(raced >= 0) {
+        _timer_problem.start();
+        idle = false;
+        mark = d = 0;
+        _cancelled = false;
+
+        if(_space_root == NULL) {
+            _space_root = static_cast<MyFlatZincSpace*>(engine()._portfolio_spaces[engine()._portfolio->group(this->id)]->clone(false));
+        }
+
+        const SubProblem& sp = engine()._subproblems[raced];
+        _run_tuples_bool = engine()._tuples_bool_resolution[sp.group];
+        _run_tuples_int = engine()._tuples_int_resolution[sp.group];
+        _run_group = sp.group;
+        _run.push_back(sp);
+        _run_size = 1;
+
+        if(_progress) {
+            _progress->idle = false;
+        }
+
+        engine().unlockFindJobResolution();
+
+        preparePrefix();
+        dispatchProblem();
+        return;
+
+    } else if(!engine()._portfolio && engine()._current_problem_resolution < engine()._groups_tuples_resolution.size()) {
 
         _timer_problem.start();
 
@@ -936,9 +1818,11 @@ EPS_BAB::Worker::find(void) {
             }
 
 
-            unsigned int index_tuple_last = engine()._current_index_tuple_resolution + engine()._groups_tuples_resolution[engine()._current_problem_resolution];
+            _subproblem = engine()._subproblems[engine()._current_problem_resolution];
+            unsigned int index_tuple_first = _subproblem.first_tuple;
+            unsigned int index_tuple_last = _subproblem.first_tuple + _subproblem.nb_tuples;
 
-            Gecode::TupleSet& bool_tuples = *engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution];
+            Gecode::TupleSet& bool_tuples = *engine()._tuples_bool_resolution[_subproblem.group];
             int nb_bool_tuples = bool_tuples.tuples();
             if(nb_bool_tuples) {
                 int arity_bool = bool_tuples.arity();
@@ -952,7 +1836,7 @@ EPS_BAB::Worker::find(void) {
                 //std::cerr << "]\n";
                 os << "\n";
 
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
+                for(unsigned int i = index_tuple_first; i < index_tuple_last; i++) {
                     Gecode::IntArgs tuple(arity_bool, bool_tuples[i]);
 
                     os << "t ";
@@ -966,7 +1850,7 @@ EPS_BAB::Worker::find(void) {
 
             }
 
-            Gecode::TupleSet& int_tuples = *engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution];
+            Gecode::TupleSet& int_tuples = *engine()._tuples_int_resolution[_subproblem.group];
             int nb_int_tuples = int_tuples.tuples();
             if(nb_int_tuples) {
                 int arity_int = int_tuples.arity();
@@ -980,7 +1864,7 @@ EPS_BAB::Worker::find(void) {
                 //std::cerr << "]\n";
                 os << "\n";
 
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
+                for(unsigned int i = index_tuple_first; i < index_tuple_last; i++) {
                     Gecode::IntArgs tuple(arity_int, int_tuples[i]);
 
                     os << "t ";
@@ -999,188 +1883,61 @@ EPS_BAB::Worker::find(void) {
             }
 
 
-            if(index_tuple_last+1 > std::max(nb_int_tuples, nb_bool_tuples)) {
-
-                engine()._current_index_tuple_resolution = 0;
-                engine()._current_index_group_tuple_resolution++;
+            engine()._current_problem_resolution++;
+            engine().releaseProblems(_subproblem.group, 1);
 
-            } else {
-                engine()._current_index_tuple_resolution = index_tuple_last;
+            if(engine()._progress) {
+                engine()._progress->dispatched = engine()._problems_base + engine()._current_problem_resolution;
             }
 
-            engine()._current_problem_resolution++;
-
             os.close();
             idle = true;
             engine()._current_problem++;
 
+            if(_progress) {
+                _progress->problems++;
+            }
+
         } else {
             idle = false;
             mark = d = 0;
 
-            MyFlatZincSpace* space_resolution = static_cast<MyFlatZincSpace*>(engine()._space_home->clone(false)); //cloning for independant worker
-
-
-
-            unsigned int index_tuple_last = engine()._current_index_tuple_resolution + engine()._groups_tuples_resolution[engine()._current_problem_resolution];
-
-            Gecode::TupleSet& bool_tuples = *engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution];
-            int nb_bool_tuples = bool_tuples.tuples();
-            if(nb_bool_tuples) {
-                int arity_bool = bool_tuples.arity();
-                Gecode::TupleSet tuples;
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
-                    Gecode::IntArgs tuple(arity_bool, bool_tuples[i]);
-
-                    /*
-                    std::cerr << "tuple[";
-                    for(int j = 0; j < tuple.size(); j++) {
-                    	std::cerr << tuple[j] << ", ";
-                    }
-                    std::cerr << "]\n";
-                    */
-                    tuples.add(tuple);
-
-                }
-                tuples.finalize();
-
-                Gecode::BoolVarArgs vars(arity_bool);
-                //std::cerr << "vars[";
-                for(int i = 0; i < arity_bool; i++) {
-                    vars[i] = space_resolution->bv[i];
-                    //    std::cerr << j << ", ";
-                }
-
-                //std::cerr << "]\n";
-                //std::cerr << "decision variables : " << s->args_iv.size() << std::endl;
-                //if(nb_bool_tuples == 1) {
-                //    for(int i = 0; i < arity_bool; i++) {
-                //        Gecode::rel(*space_resolution, vars[i], Gecode::IRT_EQ, tuples[0][i]);
-                //    }
-                //
-                //} else {
-                Gecode::extensional(*space_resolution, vars, tuples, Gecode::EPK_DEF, Gecode::ICL_DOM);
-                //}
-            }
-            //std::cerr << "Problem " << engine()._current_problem_resolution << "\n";
-
-            Gecode::TupleSet& int_tuples = *engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution];
-            int nb_int_tuples = int_tuples.tuples();
-            if(nb_int_tuples) {
-                int arity_int = int_tuples.arity();
-
-                Gecode::TupleSet tuples;
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
-                    Gecode::IntArgs tuple(arity_int, int_tuples[i]);
-                    /*
-                    std::cerr << "tuple[";
-                    for(int j = 0; j < tuple.size(); j++) {
-                    	std::cerr << tuple[j] << ", ";
-                    }
-                    std::cerr << "]\n";
-                    */
-                    tuples.add(tuple);
-                }
-                tuples.finalize();
-                /*
-                const int nb_tuples = tuples.tuples();
-
-                int* values_vertical = new int[nb_tuples];
-                for(unsigned int i = 0; i < tuples.arity(); i++) {
-
-                	for(unsigned int j = 0; j < nb_tuples; j++) {
-                		values_vertical[j] = tuples[j][i];
-                	}
-                	Gecode::IntSet values(values_vertical, nb_tuples);
-
-                	//Gecode::IntVar x(*space_resolution, values);
-
-                	Gecode::dom(*space_resolution, space_resolution->iv[i], values);
-
-                	//std::cerr << space_resolution->iv[i] << " (before) => ";
-                	//space_resolution->iv[i].update(*space_resolution, false, x);
-
-
-                	//Gecode::rel(*space_resolution, space_resolution->iv[i], Gecode::IRT_GQ, space_resolution->iv[i].min());
-                	//Gecode::rel(*space_resolution, space_resolution->iv[i], Gecode::IRT_LQ, space_resolution->iv[i].max());
-                }
-                delete [] values_vertical;
-                */
-                //for(unsigned int i = 0; i < tuples.arity(); i++) {
-                //    std::cerr << space_resolution->iv[i] << " (after)\n";
-                //}
-
-
-                Gecode::IntVarArgs vars(arity_int);
-                //std::cerr << "iv[";
-                for(int i = 0; i < arity_int; i++) {
-                    vars[i] = space_resolution->iv[i];
-                    //    std::cerr << i << ", ";
-                }
-
-                //std::cerr << "]\n\n";
-
-                //std::cerr << "decision variables : " << s->args_iv.size() << std::endl;
-                //if(nb_int_tuples == 1) {
-                //    for(int i = 0; i < arity_int; i++) {
-                //        Gecode::rel(*space_resolution, vars[i], Gecode::IRT_EQ, tuples[0][i]);
-                //    }
-
-                //} else {
-                Gecode::extensional(*space_resolution, vars, tuples, Gecode::EPK_DEF, Gecode::ICL_DOM);
-                //}
+            //The first dispatch prepares the root space of the worker, the
+            //following clones only touch this copy and are done outside the lock
+            if(_space_root == NULL) {
+                _space_root = static_cast<MyFlatZincSpace*>(engine().prototype(_node)->clone(false));
             }
 
-            //Gecode::branch(*s, s->iv, Gecode::INT_VAR_NONE(), Gecode::INT_VAL_MIN());
-            //Gecode::branch(*s, s->iv, Gecode::TieBreak<Gecode::IntVarBranch>(Gecode::INT_VAR_NONE()), Gecode::INT_VALUES_MIN());
-            /* Problem with args :S
-            if(s->args_iv.size()) {
-            	for(int i = 0; i < s->args_iv.size(); i++) {
-            		Gecode::branch(*s, s->args_iv[i], s->branch_var_iv[i], s->branch_val_iv[i]);
-            	}
-            }
-            if(s->args_bv.size()) {
-            	Gecode::branch(*s, s->args_bv, s->branch_var_bv, s->branch_val_bv);
-            }
-            if(s->args_sv.size()) {
-            	Gecode::branch(*s, s->args_sv, s->branch_var_sv, s->branch_val_sv);
-            }
-            if(s->args_fv.size()) {
-            	Gecode::branch(*s, s->args_fv, s->branch_var_fv, s->branch_val_fv);
+            //Take a chunk of consecutive subproblems of the same group, siblings of
+            //the decomposition share the propagation of their common prefix
+            const std::vector<SubProblem>& subproblems = engine()._subproblems;
+            unsigned int chunk = engine().chunkSize(this);
+            unsigned int group = subproblems[engine()._current_problem_resolution].group;
+            _run_tuples_bool = engine()._tuples_bool_resolution[group];
+            _run_tuples_int = engine()._tuples_int_resolution[group];
+            _run_group = group;
+            do {
+                _run.push_back(subproblems[engine()._current_problem_resolution]);
+                engine()._current_problem_resolution++;
+                engine()._current_problem++;
+            } while(_run.size() < chunk
+                    && engine()._current_problem_resolution < static_cast<int>(subproblems.size())
+                    && subproblems[engine()._current_problem_resolution].group == group);
+            _run_size = _run.size();
+
+            if(engine()._progress) {
+                engine()._progress->dispatched = engine()._problems_base + engine()._current_problem_resolution;
             }
-            */
-
-            if(index_tuple_last+1 > std::max(nb_int_tuples, nb_bool_tuples)) {
-                //delete engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution];
-                //delete engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution];
-
-                //engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution] = NULL;
-                //engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution] = NULL;
-
-                engine()._current_index_tuple_resolution = 0;
-                engine()._current_index_group_tuple_resolution++;
 
-            } else {
-                engine()._current_index_tuple_resolution = index_tuple_last;
+            if(_progress) {
+                _progress->idle = false;
             }
 
-            engine()._current_problem_resolution++;
-
-
-            if(cur) {
-                delete cur;
-            }
+            engine().unlockFindJobResolution();
 
-            cur = space_resolution;
-
-            if (best) {
-                cur->constrain(*best);
-
-            }
-
-
-
-            engine()._current_problem++;
+            preparePrefix();
+            dispatchProblem();
+            return;
         }
 
     } else if(engine()._nb_workers_decomposition_done == engine().workers()) {
@@ -1189,6 +1946,10 @@ EPS_BAB::Worker::find(void) {
         if(!done) {
             engine().idle();
 
+            if(_progress) {
+                _progress->idle = true;
+            }
+
 
             done = true;
 
@@ -1255,6 +2016,15 @@ EPS_BAB::statistics(void) const {
  */
 void
 EPS_BAB::Worker::run(void) {
+    if(_cpu >= 0 && !pinThread(_cpu)) {
+        //The worker runs unpinned, so it clones its subproblems from the root space
+        std::cerr << "Warning: worker " << id << " could not be pinned on cpu " << _cpu << std::endl;
+        _node = -1;
+        _cpu = -1;
+    }
+    //Allocations of the worker come from its own arena (jemalloc only)
+    allocatorBindThread();
+    _memory.start();
     // Peform initial delay, if not first worker
     //if (this != engine().worker(0))
     //    Gecode::Support::Thread::sleep(Gecode::Search::Config::initial_delay);
@@ -1277,6 +2047,23 @@ EPS_BAB::Worker::run(void) {
             // Perform exploration work
         {
             if(!done) {
+                if(_cancelled && !idle) {
+                    //Another branching finished the subproblem first, the incumbent is kept
+                    delete cur;
+                    cur = NULL;
+                    path.reset(0);
+                    disarmRestarts();
+                    dropRaced();
+                    idle = true;
+                }
+                if(_restart_root && !idle && fail >= _restart_limit) {
+                    //Heavy tailed subproblem, solve it again with what the heuristics learnt
+                    restartProblem();
+                }
+                if(_det_wait && !idle && !openProblem()) {
+                    //The engine is deleted, the subproblems before the window will not be committed
+                    break;
+                }
                 //m.acquire();
                 if (idle) {
                     //m.release();
@@ -1290,6 +2077,9 @@ EPS_BAB::Worker::run(void) {
                     } else {
 
                         node++;
+                        if(_progress) {
+                            _progress->nodes = node;
+                        }
                         switch (cur->status(*this)) {
 
                         case Gecode::SS_FAILED:
@@ -1302,9 +2092,17 @@ EPS_BAB::Worker::run(void) {
                             // Deletes all pending branchers
                             (void) cur->choice();
 
+                            delete best;
                             best = cur;
-
                             cur = NULL;
+                            _det_found = true;
+                            //Origin and time of the solution, kept by its clones up to the trajectory
+                            static_cast<MyFlatZincSpace*>(best)->stampSolution(id, _subproblem.id);
+
+                            if(!engine().optSearch.deterministic) {
+                                //Reported as soon as found, a better incumbent of another worker replaces it
+                                engine().solution(this);
+                            }
                         }
                         break;
                         case Gecode::SS_BRANCH: {
@@ -1321,6 +2119,8 @@ EPS_BAB::Worker::run(void) {
 
                             const Gecode::Choice* ch = path.push(*this,cur,c);
                             cur->commit(*ch,0);
+                            //Clones of the path, the current space, the root and the prefix of the worker
+                            _memory.sample((path.entries() / engine().opt().c_d + 4) * engine()._space_home->_memory_space);
                         }
                         break;
                         default:
@@ -1337,10 +2137,27 @@ EPS_BAB::Worker::run(void) {
 
                 } else {
                     idle = true;
+                    disarmRestarts();
 
-                    engine().solution(this);
-                    //add timer for finished a subproblem
-                    engine().notifyFinishedSubproblem(this->id, _timer_problem.stop());
+                    if(engine().optSearch.deterministic) {
+                        engine().commitProblem(this);
+                    } else {
+                        engine().solution(this);
+                    }
+                    //A raced subproblem is only accounted by the group which wins it
+                    if(!engine()._portfolio || engine().winRaced(this)) {
+                        //add timer for finished a subproblem
+                        double time_problem = _timer_problem.stop();
+                        engine().notifyFinishedSubproblem(this->id, _subproblem, time_problem);
+                        if(engine()._space_home->_memory_workers) {
+                            (*engine()._space_home->_memory_workers)[this->id] = _memory.peak();
+                        }
+                        _problem_statistics.add(time_problem);
+
+                        if(_progress) {
+                            _progress->problems++;
+                        }
+                    }
 
                 }
             }
@@ -1353,20 +2170,50 @@ EPS_BAB::Worker::run(void) {
 }
 
 
+/*
+ * Engine: NUMA prototypes
+ */
+MyFlatZincSpace*
+EPS_BAB::prototype(int node) {
+    if(node < 0) {
+        return _space_home;
+    }
+    //The first worker of the node clones it, so its memory is local to the node
+    if(_space_nodes[node] == NULL) {
+        _space_nodes[node] = static_cast<MyFlatZincSpace*>(_space_home->clone(false));
+    }
+    return _space_nodes[node];
+}
+
 /*
  * Termination and deletion
  */
 EPS_BAB::Worker::~Worker(void) {
     delete best;
+    delete _space_prefix;
+    delete _space_root;
+    disarmRestarts();
 }
 
 EPS_BAB::~EPS_BAB(void) {
 
     if(_workers) {
+        if(optSearch.deterministic) {
+            //The workers blocked for the commits must see the termination
+            m_search.acquire();
+            _det_closed = true;
+            wakeDeterministic();
+            m_search.release();
+        }
         terminate();
         Gecode::heap.rfree(_workers);
     }
 
+    if(_progress) {
+        _progress->stop();
+        delete _progress;
+    }
+
     if(best) {
         delete best;
     }
@@ -1375,11 +2222,48 @@ EPS_BAB::~EPS_BAB(void) {
         delete _master;
     }
 
+    delete _frontier;
+    delete _stream;
+    delete _portfolio;
+    STLDeleteElements(&this->_portfolio_spaces);
+
+    STLDeleteElements(&this->_det_results);
+    for(size_t i = 0; i < _det_bounds.size(); i++) {
+        delete _det_bounds[i].second;
+    }
+
+    STLDeleteElements(&this->_space_nodes);
     STLDeleteElements(&this->_tuples_bool_resolution);
     STLDeleteElements(&this->_tuples_int_resolution);
 
 }
 
+void
+EPS_BAB::Worker::addLevelTuple(MyFlatZincSpace* s, unsigned int level) {
+    unsigned int nb_bool_decision_variables = s->bv.size();
+
+    Gecode::IntArgs tuple_int;
+    Gecode::IntArgs tuple_bool;
+
+    //no add the objective val int tuple
+    for (unsigned int i = 0; i < level; i++) {
+        if(i < nb_bool_decision_variables) {
+            tuple_bool << s->bv[i].val();
+        } else {
+            tuple_int << s->iv[i - nb_bool_decision_variables].val();
+        }
+    }
+
+    //Version no collapse last level
+    if(tuple_bool.size()) {
+        _tuples_bool_ndi->add(tuple_bool);
+    }
+
+    if(tuple_int.size()) {
+        _tuples_int_ndi->add(tuple_int);
+    }
+}
+
 ///decomposeProblems
 void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o) {
     _group_tuples.clear();
@@ -1411,12 +2295,18 @@ void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOption
 
     BoundedBAB dbdfs(NULL, opt);
 
+    MemoryPeak memory;
+    memory.start();
+    size_t memory_space = engine()._space_home->_memory_space;
+
     s->_iterations_decomposition = 0;
 
     /// Queue of solutions
 
     std::list<MyFlatZincSpace*> sub_problems;
     std::list<MyFlatZincSpace*> tmp_sub_problems;
+    /// Whether subproblems were stored as tuples to stay within the memory budget
+    bool limited = false;
 
     Gecode::StatusStatistics sstat;
     Gecode::SpaceStatus ss;
@@ -1660,6 +2550,19 @@ void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOption
                         tmp_sub_problems.pop_back();
                     }
 
+                } else if(opt.memory_budget && (sub_problems.size() + 3) * memory_space > opt.memory_budget) {
+
+                    //Over the budget the subproblem is only kept as its tuple, the next solutions do not prune it
+                    addLevelTuple(solution, level);
+                    delete solution;
+                    limited = true;
+
+                    if(best) {
+                        dbdfs.best = best->clone();
+                    } else {
+                        dbdfs.best = s->clone();
+                    }
+
                 } else {
 
                     //nb_tuples++;
@@ -1675,6 +2578,9 @@ void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOption
                     //m.release();
 
                 }
+                //The subproblems of the level are kept until it is done
+                memory.sample((sub_problems.size() + 2) * memory_space);
+
                 //m.acquire();
                 solution = static_cast<MyFlatZincSpace*>(dbdfs.next());
                 //m.release();
@@ -1694,27 +2600,7 @@ void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOption
                 std::cerr << sb_problem->iv[sb_problem->optVar()] << std::endl;
 #endif
 
-                Gecode::IntArgs tuple_int;
-                Gecode::IntArgs tuple_bool;
-
-                //no add the objective val int tuple
-                for (unsigned int i = 0; i < level; i++) {
-                    //std::cerr << i+1 << " : " << solution->iv[i].val() << std::endl;
-                    if(i < nb_bool_decision_variables) {
-                        tuple_bool << sb_problem->bv[i].val();
-                    } else {
-                        tuple_int << sb_problem->iv[i - nb_bool_decision_variables].val();
-                    }
-                }
-
-                //Version no collapse last level
-                if(tuple_bool.size()) {
-                    _tuples_bool_ndi->add(tuple_bool);
-                }
-
-                if(tuple_int.size()) {
-                    _tuples_int_ndi->add(tuple_int);
-                }
+                addLevelTuple(sb_problem, level);
 
                 //Version with collapse last level
                 /*
@@ -1766,6 +2652,15 @@ void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOption
             _tuples_bool_ndi->finalize();
         }
 
+        //The tuples of the level and the spaces of the bounded search
+        memory.sample(tupleSetMemory(*_tuples_bool_ndi) + tupleSetMemory(*_tuples_int_ndi)
+                      + (stat.depth / opt.c_d + 2) * memory_space);
+        s->_memory_decomposition = memory.peak();
+        if(limited) {
+            s->_memory_limited++;
+            limited = false;
+        }
+
 
         if(_tuples_int_ndi || _tuples_bool_ndi) {
             product_domain = _tuples_bool_ndi && _tuples_bool_ndi->tuples() ? _tuples_bool_ndi->tuples() : _tuples_int_ndi->tuples();
@@ -1825,6 +2720,13 @@ void EPS_BAB::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOption
 
             _group_tuples.resize(newP, 1);
 
+            //STOP
+            break;
+        } else if(opt.memory_budget && 2 * memory.peak() > opt.memory_budget) {
+            //The next level would at least double the memory, the tuples of this one are the subproblems
+            _group_tuples.resize(product_domain, 1);
+            s->_memory_limited++;
+
             //STOP
             break;
         } else if(level == nb_decision_variables) {
@@ -1872,11 +2774,26 @@ eps_bab_to_engine(Gecode::Space* s, const MySearchOptions& o) {
     to.c_d = o.c_d;
     to.clone = o.clone;
     to.stop = o.stop;
-    to.cutoff = to.cutoff;
+    to.cutoff = o.cutoff;
     to.nb_problems = o.nb_problems;
     to.mode_decomposition = o.mode_decomposition;
     to.mode_search = o.mode_search;
     to.obj_file = o.obj_file;
+    to.progress_interval = o.progress_interval;
+    to.progress_file = o.progress_file;
+    to.order = o.order;
+    to.probe_nodes = o.probe_nodes;
+    to.affinity = o.affinity;
+    to.chunk_size = o.chunk_size;
+    to.chunk = o.chunk;
+    to.chunk_time = o.chunk_time;
+    to.memory_budget = o.memory_budget;
+    to.stream_batch = o.stream_batch;
+    to.restart = o.restart;
+    to.restart_scale = o.restart_scale;
+    to.restart_base = o.restart_base;
+    to.portfolio = o.portfolio;
+    to.deterministic = o.deterministic;
 
     //std::cerr << o.nb_problems << std::endl;
     //std::cerr << o.mode_decomposition << std::endl;
@@ -44,12 +44,21 @@
 #include <vector>
 #include <string>
 #include <list>
+#include <deque>
+#include <algorithm>
 #include <fstream>
+#include <cstring>
 
 #include "search.h"
 #include "flatzinc.h"
 #include "stl_util.h"
 #include "lock.h"
+#include "progress.h"
+#include "affinity.h"
+#include "frontier.h"
+#include "allocator.h"
+#include "memory.h"
+#include "portfolio.h"
 
 using namespace stl_util;
 
@@ -169,12 +178,85 @@ protected:
 
         Gecode::Support::Timer _timer_problem;
 
+        /// Subproblem being solved
+        SubProblem _subproblem;
+
+        /// Progress counters of the worker (NULL if no progress report)
+        WorkerProgress* _progress;
+
+        /// NUMA node and cpu the worker is pinned on (-1 if not pinned)
+        int _node;
+        int _cpu;
+
+        /// Root space of the worker, the subproblems are cloned from it outside the lock
+        MyFlatZincSpace* _space_root;
+
+        /// Dispatches of the worker, merged in the engine statistics at the next acquisition of the lock
+        DurationStatistics _dispatch_statistics;
+
+        /// Durations of the subproblems solved by the worker (adaptive chunks)
+        DurationStatistics _problem_statistics;
+
+        /// Peak memory held by the worker
+        MemoryPeak _memory;
+
+        /// Solutions counted by the worker (NULL if they are reported)
+        SolutionCounter* _counter;
+        /// Solutions printed by the worker (NULL if they are not printed by the workers)
+        SolutionShard* _shard;
+
+        /// Subproblems taken at the last dispatch and not started yet (all from the same group)
+        std::deque<SubProblem> _run;
+        /// Tuples of the group of the run
+        Gecode::TupleSet* _run_tuples_bool;
+        Gecode::TupleSet* _run_tuples_int;
+        /// Group and number of subproblems of the run
+        unsigned int _run_group;
+        unsigned int _run_size;
+        /// Root space propagated with the prefix common to the run (NULL if none)
+        MyFlatZincSpace* _space_prefix;
+
+        /// Clone of the subproblem the worker restarts from (NULL if it does not restart)
+        Gecode::Space* _restart_root;
+        /// Restart sequence of the subproblem
+        Gecode::Search::Cutoff* _cutoff;
+        /// Failures after which the subproblem restarts
+        unsigned long int _restart_limit;
+
+        /// Set when another group of the portfolio won the raced subproblem
+        volatile bool _cancelled;
+        /// Solutions of the raced subproblem, reported if the group of the worker wins it,
+        /// or once the subproblems before it are committed (deterministic mode)
+        std::vector<Gecode::Space*> _raced_solutions;
+
+        /// Propagate the prefix common to the subproblems of the run
+        void preparePrefix(void);
+        /// Clone the space of subproblem \a sp and post its tuples
+        MyFlatZincSpace* prepareProblem(const SubProblem& sp);
+        /// Start the next subproblem of the run
+        void dispatchProblem(void);
+        /// Restart the subproblem just dispatched when its failures reach the cutoff
+        void armRestarts(void);
+        /// Stop restarting the current subproblem
+        void disarmRestarts(void);
+        /// Solve the current subproblem again from its root
+        void restartProblem(void);
+        /// Drop the raced subproblem and its solutions
+        void dropRaced(void);
+        /// Report the solutions of the raced subproblem if the group of the worker wins it
+        bool finishRaced(void);
+
         void decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o);
 
+        /// Expand nodes of the shared frontier until the decomposition is over
+        void expandFrontier(void);
+
         void RDFS(MyFlatZincSpace* s, const MySearchOptions& o);
 
         /// Initialize for space \a s (of size \a sz) with engine \a e
         Worker(Gecode::Space* s, EPS_DFS& e, unsigned int id_worker);
+        /// Delete the root space of the worker
+        virtual ~Worker(void);
         /// Provide access to engine
         EPS_DFS& engine(void) const;
         /// Start execution of worker
@@ -191,9 +273,80 @@ protected:
 
     enum ModeDecomposition {
         SEQUENTIAL,    //< SEQUENTIAL
-        PARALLEL       //< PARALLEL
+        PARALLEL,      //< PARALLEL
+        FRONTIER,      //< FRONTIER (recursive parallel decomposition)
+        STREAM         //< STREAM (lazy decomposition dispatched in batches)
     } _mode_decomposition;
 
+    /// Frontier shared by the workers (FRONTIER decomposition only)
+    Frontier* _frontier;
+
+    /// Lazy decomposition (STREAM decomposition only)
+    PrefixStream* _stream;
+    /// Lock of the stream, the batches are generated outside of the lock of resolution
+    Gecode::Support::Mutex m_stream;
+
+    /// Solutions reported by the workers and the decomposition
+    unsigned long int _nb_solutions;
+    /// Set once the solution limit is reached, the workers then drop their work
+    volatile bool _limit_reached;
+    /// Started when the solution limit is reached
+    Gecode::Support::Timer _timer_limit;
+
+    /// Memory block of the solution counters of the workers (not aligned, count only)
+    void* _counters_mem;
+    /// Solution counters of the workers (NULL if the solutions are reported)
+    SolutionCounter* _counters;
+    /// Solutions counted by the sequential decomposition
+    unsigned long int _count_master;
+    /// Solutions printed by the sequential decomposition (shards printing)
+    SolutionShard* _shard_master;
+    /// Solutions printed by the workers (shards printing)
+    std::vector<SolutionShard*> _shards;
+
+    /// Solutions of each finished subproblem not committed yet, by id (deterministic mode)
+    std::vector< std::vector<Gecode::Space*> > _det_solutions;
+    std::vector<bool> _det_done;
+    /// First subproblem not committed
+    unsigned int _det_next;
+    /// Solutions held by the subproblems not committed
+    size_t _det_held;
+
+    /// Queue solution \a s (lock of search held)
+    void pushSolution(Gecode::Space* s);
+    /// Commit the subproblem finished by \a w, the solutions are reported in subproblem order
+    void commitProblem(Worker* w);
+
+    /// Whether the workers count (and print) the solutions instead of reporting them
+    bool counted(void) const {
+        return optSearch.count_only || optSearch.shards != NULL;
+    }
+
+    /// Count (and print) the solution \a s found by \a w instead of reporting it
+    void countSolution(Worker* w, Gecode::Space* s) {
+        if(w->_counter) {
+            w->_counter->count++;
+        } else {
+            _count_master++;
+        }
+        if(optSearch.shards) {
+            SolutionShard* shard = w->_shard ? w->_shard : _shard_master;
+            shard->print(static_cast<MyFlatZincSpace*>(s), *optSearch.shards->printer);
+        }
+    }
+
+    /// Record that a worker dropped its work after the solution limit
+    void limitStopped(void) {
+        m_search.acquire();
+        double t = _timer_limit.stop();
+        if(t > _space_home->_time_limit_stop) {
+            _space_home->_time_limit_stop = t;
+        }
+        m_search.release();
+    }
+    /// Time spent generating the batches (in ms)
+    double _time_stream;
+
     /// space generated by parsing flatzinc file
     MyFlatZincSpace* _space_home;
 
@@ -204,17 +357,24 @@ protected:
     int _current_index_problem_decomposition;
 
     int _current_problem_resolution;
-    int _current_index_tuple_resolution;
     int _current_index_problem_resolution;
 
     int _current_problem;
 
-    int _current_index_group_tuple_resolution;
 
     std::vector<int> _groups_tuples_resolution;
     std::vector<Gecode::TupleSet*> _tuples_bool_resolution;
     std::vector<Gecode::TupleSet*> _tuples_int_resolution;
 
+    /// Subproblems in dispatch order (the first _current_problem_resolution are dispatched)
+    std::vector<SubProblem> _subproblems;
+    /// Subproblems of the batches released before _subproblems (STREAM decomposition only)
+    unsigned int _problems_base;
+    /// Subproblems of each group not solved yet
+    std::vector<unsigned int> _group_pending;
+    /// Memory of the tuples of the groups not released
+    size_t _memory_subproblems_live;
+
     std::vector<int> _problems_for_decomposition;
     int _nb_workers_decomposition_done;
 
@@ -225,13 +385,36 @@ protected:
     //Timer to compute the duration of decomposition
     Gecode::Support::Timer _timer_decomposition;
 
+    /// Progress of the search read by the reporter thread (NULL if no report)
+    ProgressMonitor* _progress;
+
+    /// Root space cloned on each NUMA node (empty if no affinity)
+    std::vector<MyFlatZincSpace*> _space_nodes;
+
+    /// Root space to clone the subproblems of the workers of \a node from
+    MyFlatZincSpace* prototype(int node);
+
+    /// Race of the branchings on the subproblems (NULL if no portfolio)
+    Portfolio* _portfolio;
+    /// Root space of each group of the portfolio
+    std::vector<MyFlatZincSpace*> _portfolio_spaces;
+
+    /// Post the branchings of the portfolio on clones of the space without branchings
+    void createPortfolio(void);
+    /// Worker \a w finished its raced subproblem, false if another group won it first
+    bool winRaced(Worker* w);
+
     unsigned int getBusyWorkers() {
         return this->n_busy;
     }
 
+    /// Contention of the engine locks (owned by the root space if any)
+    EngineLockStatistics* _lock_statistics;
+    EngineLockStatistics _lock_statistics_engine;
+
     Gecode::Support::Mutex m_findjob_resolution;
     void lockFindJobResolution() {
-        m_findjob_resolution.acquire();
+        _lock_statistics->findjob_resolution.acquire(m_findjob_resolution);
     }
 
     void unlockFindJobResolution() {
@@ -240,15 +423,206 @@ protected:
 
     Gecode::Support::Mutex m_findjob_decomposition;
     void lockFindJobDecomposition() {
-        m_findjob_decomposition.acquire();
+        _lock_statistics->findjob_decomposition.acquire(m_findjob_decomposition);
     }
 
     void unlockFindJobDecomposition() {
         m_findjob_decomposition.release();
     }
 
-    void notifyFinishedSubproblem(unsigned int id_worker, double time_problem) {
+    void notifyFinishedSubproblem(unsigned int id_worker, const SubProblem& sp, double time_problem) {
         (*_space_home->_time_subproblems_workers)[id_worker].push_back(static_cast<unsigned int>(floor(time_problem)));
+        if(_space_home->_trace_subproblems_workers) {
+            (*_space_home->_trace_subproblems_workers)[id_worker].push_back(SubProblemTrace(sp.id, sp.hardness, static_cast<unsigned int>(floor(time_problem))));
+        }
+    }
+
+    /// Group the leaves of the complete frontier in \a groups with their estimated \a hardness (lock of resolution not held)
+    void groupFrontier(std::vector<FrontierGroup>& groups, std::vector< std::vector<double> >& hardness) {
+        _frontier->groups(_space_home->_space_hook->bv.size(), groups);
+        hardness.resize(groups.size());
+        if(optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+            //The other workers are done with the hook, only the caller clones it
+            for(size_t i = 0; i < groups.size(); i++) {
+                std::vector<int> group_tuples(groups[i].size, 1);
+                estimateHardness(_space_home->_space_hook, group_tuples,
+                                 groups[i].tuples_bool, groups[i].tuples_int, optSearch.probe_nodes, hardness[i]);
+            }
+        }
+    }
+
+    /// Append the \a groups of leaves of the frontier as subproblems, through the tuples of \a w (lock of resolution held)
+    void addFrontier(Worker* w, const std::vector<FrontierGroup>& groups, const std::vector< std::vector<double> >& hardness) {
+        for(size_t i = 0; i < groups.size(); i++) {
+            w->_tuples_bool_ndi = new Gecode::TupleSet(groups[i].tuples_bool);
+            w->_tuples_int_ndi = new Gecode::TupleSet(groups[i].tuples_int);
+            w->_group_tuples.assign(groups[i].size, 1);
+
+            addProblems(w, hardness[i]);
+
+            delete w->_tuples_bool_ndi;
+            w->_tuples_bool_ndi = NULL;
+            delete w->_tuples_int_ndi;
+            w->_tuples_int_ndi = NULL;
+            w->_group_tuples.clear();
+        }
+
+        _space_home->_nodes_decomposition = _frontier->nodes();
+        _space_home->_fails_decomposition = _frontier->fails();
+        _space_home->_depth_decomposition = _frontier->depth();
+        _space_home->_memory_decomposition += _frontier->memory();
+        if(_frontier->limited()) {
+            _space_home->_memory_limited++;
+        }
+        _space_home->_problems = _groups_tuples_resolution.size();
+    }
+
+    /// Release \a n solved subproblems of \a group, a streamed group is freed with its last one (lock of resolution held)
+    void releaseProblems(unsigned int group, unsigned int n) {
+        _group_pending[group] -= n;
+        if(_mode_decomposition == STREAM && _group_pending[group] == 0) {
+            _memory_subproblems_live -= tupleSetMemory(*_tuples_bool_resolution[group])
+                                        + tupleSetMemory(*_tuples_int_resolution[group]);
+            delete _tuples_bool_resolution[group];
+            _tuples_bool_resolution[group] = NULL;
+            delete _tuples_int_resolution[group];
+            _tuples_int_resolution[group] = NULL;
+        }
+    }
+
+    /// Append the next batch of the stream as subproblems, through the tuples of \a w (lock of resolution not held)
+    void refillStream(Worker* w) {
+        m_stream.acquire();
+
+        //Another worker may have refilled meanwhile
+        lockFindJobResolution();
+        bool generate = _current_problem_resolution == static_cast<int>(_subproblems.size())
+                        && _nb_workers_decomposition_done < static_cast<int>(workers());
+        if(generate) {
+            //Every subproblem is dispatched, only the groups still solved are kept
+            _problems_base += _subproblems.size();
+            _subproblems.clear();
+            _groups_tuples_resolution.clear();
+            _current_problem_resolution = 0;
+        }
+        unlockFindJobResolution();
+
+        if(!generate) {
+            m_stream.release();
+            return;
+        }
+
+        Gecode::Support::Timer t;
+        t.start();
+
+        std::vector<FrontierGroup> groups;
+        _stream->batch(optSearch.stream_batch, _space_home->_space_hook->bv.size(), groups);
+
+        std::vector< std::vector<double> > hardness(groups.size());
+        if(optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+            for(size_t i = 0; i < groups.size(); i++) {
+                std::vector<int> group_tuples(groups[i].size, 1);
+                estimateHardness(_space_home->_space_hook, group_tuples,
+                                 groups[i].tuples_bool, groups[i].tuples_int, optSearch.probe_nodes, hardness[i]);
+            }
+        }
+
+        lockFindJobResolution();
+        for(size_t i = 0; i < groups.size(); i++) {
+            w->_tuples_bool_ndi = new Gecode::TupleSet(groups[i].tuples_bool);
+            w->_tuples_int_ndi = new Gecode::TupleSet(groups[i].tuples_int);
+            w->_group_tuples.assign(groups[i].size, 1);
+
+            addProblems(w, hardness[i]);
+
+            delete w->_tuples_bool_ndi;
+            w->_tuples_bool_ndi = NULL;
+            delete w->_tuples_int_ndi;
+            w->_tuples_int_ndi = NULL;
+            w->_group_tuples.clear();
+        }
+
+        _time_stream += t.stop();
+        _space_home->_time_decomposition = static_cast<unsigned int>(floor(_time_stream));
+        _space_home->_problems = _problems_base + _groups_tuples_resolution.size();
+        if(_progress) {
+            _progress->problems = _space_home->_problems;
+        }
+
+        if(_stream->done()) {
+            _space_home->_nodes_decomposition = _stream->nodes();
+            _space_home->_fails_decomposition = _stream->fails();
+            _space_home->_depth_decomposition = _stream->depth();
+            _space_home->_memory_decomposition = _stream->memory();
+            _nb_workers_decomposition_done = workers();
+            if(_progress) {
+                _progress->decomposed = true;
+            }
+        }
+        unlockFindJobResolution();
+
+        m_stream.release();
+    }
+
+    /// Number of subproblems to hand to \a w at once (lock of resolution held)
+    unsigned int chunkSize(const Worker* w) const {
+        unsigned int left = _subproblems.size() - _current_problem_resolution;
+        //Guided chunks keep enough subproblems for every worker to balance the end of the search
+        unsigned int guided = left / (2 * workers());
+        unsigned int size = optSearch.chunk_size;
+        switch(optSearch.chunk) {
+        case MyFlatZincOptions::CHUNK_GUIDED:
+            size = std::max(size, guided);
+            break;
+        case MyFlatZincOptions::CHUNK_ADAPTIVE:
+            if(w->_problem_statistics.count) {
+                double average = std::max(w->_problem_statistics.average(), 0.001);
+                unsigned int adaptive = static_cast<unsigned int>(optSearch.chunk_time / average);
+                size = std::max(size, std::min(adaptive, guided));
+            }
+            break;
+        default:
+            break;
+        }
+        return std::max(size, 1u);
+    }
+
+    /// Append the subproblems decomposed by \a w with their estimated \a hardness (lock of resolution held)
+    void addProblems(Worker* w, const std::vector<double>& hardness) {
+        unsigned int group = _tuples_bool_resolution.size();
+        unsigned int first_tuple = 0;
+        size_t batch = _subproblems.size();
+        for(size_t i = 0; i < w->_group_tuples.size(); i++) {
+            _subproblems.push_back(SubProblem(_problems_base + _subproblems.size(), group, first_tuple, w->_group_tuples[i],
+                                              i < hardness.size() ? hardness[i] : 0.0));
+            first_tuple += w->_group_tuples[i];
+        }
+
+        _groups_tuples_resolution.insert(_groups_tuples_resolution.end(), w->_group_tuples.begin(), w->_group_tuples.end());
+        _tuples_bool_resolution.push_back(new Gecode::TupleSet(*w->_tuples_bool_ndi));
+        _tuples_int_resolution.push_back(new Gecode::TupleSet(*w->_tuples_int_ndi));
+
+        if(!_tuples_bool_resolution.back()->finalized()) {
+            _tuples_bool_resolution.back()->finalize();
+        }
+
+        if(!_tuples_int_resolution.back()->finalized()) {
+            _tuples_int_resolution.back()->finalize();
+        }
+
+        _group_pending.push_back(w->_group_tuples.size());
+        _memory_subproblems_live += tupleSetMemory(*_tuples_bool_resolution.back())
+                                    + tupleSetMemory(*_tuples_int_resolution.back());
+        _space_home->_memory_subproblems = std::max(_space_home->_memory_subproblems, _memory_subproblems_live);
+
+        //Longest processing time first among the subproblems not dispatched yet, which are
+        //already sorted: only the batch is sorted, then merged after the pending ones of equal
+        //hardness. The groups of a portfolio go through the subproblems in the same order
+        if(optSearch.order == MyFlatZincOptions::ORDER_LPT && !_portfolio) {
+            std::stable_sort(_subproblems.begin() + batch, _subproblems.end(), HarderSubProblem());
+            std::inplace_merge(_subproblems.begin() + _current_problem_resolution, _subproblems.begin() + batch,
+                               _subproblems.end(), HarderSubProblem());
+        }
     }
 
 public:
@@ -259,6 +633,8 @@ public:
     //@{
     /// Report solution \a s
     void solution(Gecode::Space* s);
+    /// Return next solution, the counted solutions are summed once the search is over
+    virtual Gecode::Space* next(void);
     /// Reset engine to restart at space \a s and return new root space
     //TODO See Engine Code
     void reset(Gecode::Space* s) {
@@ -317,10 +693,33 @@ EPS_DFS::Worker::Worker(Gecode::Space* s, EPS_DFS& e, unsigned int id_worker)
       mode_search(DECOMPOSITION),
       id(id_worker),
       _tuples_bool_ndi(NULL),
-      _tuples_int_ndi(NULL) {
+      _tuples_int_ndi(NULL),
+      _progress(NULL),
+      _node(-1),
+      _cpu(-1),
+      _space_root(NULL),
+      _counter(NULL),
+      _shard(NULL),
+      _run_tuples_bool(NULL),
+      _run_tuples_int(NULL),
+      _run_group(0),
+      _run_size(0),
+      _space_prefix(NULL),
+      _restart_root(NULL),
+      _cutoff(NULL),
+      _restart_limit(0),
+      _cancelled(false) {
     idle = true;
 }
 
+forceinline
+EPS_DFS::Worker::~Worker(void) {
+    delete _space_prefix;
+    delete _space_root;
+    disarmRestarts();
+    STLDeleteElements(&_raced_solutions);
+}
+
 forceinline
 EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
     : Gecode::Search::Parallel::Engine(o),
@@ -330,20 +729,50 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
       _current_index_tuple_decomposition(0),
       _current_index_problem_decomposition(0),
       _current_problem_resolution(0),
-      _current_index_tuple_resolution(0),
       _current_index_problem_resolution(0),
-      _current_index_group_tuple_resolution(0),
       _current_problem(0),
       _nb_workers_decomposition_done(0),
-      _mode_decomposition(PARALLEL), optSearch(o) {
+      _mode_decomposition(PARALLEL),
+      _frontier(NULL),
+      _stream(NULL),
+      _nb_solutions(0),
+      _limit_reached(false),
+      _counters_mem(NULL),
+      _counters(NULL),
+      _count_master(0),
+      _shard_master(NULL),
+      _det_next(0),
+      _det_held(0),
+      _time_stream(0.0),
+      optSearch(o),
+      _problems_base(0),
+      _memory_subproblems_live(0),
+      _progress(NULL),
+      _portfolio(NULL) {
 
     _workers = NULL;
     _master = new Worker(NULL,*this, -1);
+    if(optSearch.shards) {
+        _shard_master = new SolutionShard();
+    }
+
+    _lock_statistics = _space_home->_lock_statistics ? _space_home->_lock_statistics : &_lock_statistics_engine;
+
+    //Report the progress from the decomposition on
+    if(o.progress_interval > 0) {
+        _progress = new ProgressMonitor(workers());
+        _progress->start(o.progress_interval, o.progress_file);
+    }
 
     //Start Timer
     _timer_decomposition.start();
 
-    if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::DBDFSwP
+    if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::SDBDFS) {
+        _mode_decomposition = STREAM;
+    } else if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::RDBDFSwP
+            && optSearch.threads > 1) {
+        _mode_decomposition = FRONTIER;
+    } else if(optSearch.mode_decomposition == MyFlatZincOptions::ModeDecomposition::DBDFSwP
             && optSearch.threads > 1) {
         _mode_decomposition = PARALLEL;
     } else {
@@ -353,23 +782,37 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
     //Force sequential
     //_mode_decomposition = SEQUENTIAL;
 
-    if(_mode_decomposition == SEQUENTIAL) {
-        optSearch.nb_problems = o.nb_problems;
-    } else {
+    if(_mode_decomposition == PARALLEL) {
         optSearch.nb_problems = o.threads;
+    } else {
+        optSearch.nb_problems = o.nb_problems;
     }
 
     _space_home->_space_hook->_nodes_decomposition = 0;
     _space_home->_space_hook->_fails_decomposition = 0;
     _space_home->_space_hook->_memory_decomposition = 0;
     _space_home->_space_hook->_iterations_decomposition = 0;
+    _space_home->_space_hook->_memory_limited = 0;
     _space_home->_space_hook->_depth_decomposition = 0;
+    _space_home->_memory_subproblems = 0;
+
+    //Measured while no worker allocates
+    _space_home->_memory_space = spaceMemory(_space_home->_space_hook);
 
     _master->done = false;
     //Gecode::Support::Timer t_solve;
     //t_solve.start();
 
-    _master->decomposeProblems(_space_home->_space_hook, optSearch);
+    if(_mode_decomposition == FRONTIER) {
+        //The workers expand the decomposition from the root
+        _frontier = new Frontier(optSearch.nb_problems, optSearch.memory_budget);
+    } else if(_mode_decomposition == STREAM) {
+        //The workers generate the subproblems by batches when they run out of them
+        _stream = new PrefixStream(static_cast<MyFlatZincSpace*>(_space_home->_space_hook->clone(false)),
+                                   optSearch.nb_problems);
+    } else {
+        _master->decomposeProblems(_space_home->_space_hook, optSearch);
+    }
 
     unsigned int time_solve = static_cast<unsigned int>(floor(this->_timer_decomposition.stop()));
     //std::cerr << "Time resolution : " << time_solve << std::endl;
@@ -389,17 +832,18 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
         _nb_workers_decomposition_done = workers();
 
         if(!_master->_group_tuples.empty()) {
-            _groups_tuples_resolution.insert(_groups_tuples_resolution.end(), _master->_group_tuples.begin(), _master->_group_tuples.end());
-            _tuples_bool_resolution.push_back(new Gecode::TupleSet(*_master->_tuples_bool_ndi));
-            _tuples_int_resolution.push_back(new Gecode::TupleSet(*_master->_tuples_int_ndi));
-
-            if(!_tuples_bool_resolution.back()->finalized()) {
-                _tuples_bool_resolution.back()->finalize();
+            std::vector<double> hardness;
+            if(optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+                estimateHardness(_space_home->_space_hook, _master->_group_tuples,
+                                 *_master->_tuples_bool_ndi, *_master->_tuples_int_ndi, optSearch.probe_nodes, hardness);
             }
+            addProblems(_master, hardness);
+        }
 
-            if(!_tuples_int_resolution.back()->finalized()) {
-                _tuples_int_resolution.back()->finalize();
-            }
+        if(optSearch.deterministic) {
+            //The subproblems are committed in generation order
+            _det_solutions.resize(_subproblems.size());
+            _det_done.assign(_subproblems.size(), false);
         }
 
         delete _master->_tuples_bool_ndi;
@@ -424,16 +868,22 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
     _space_home->_fails_decomposition = _space_home->_space_hook->_fails_decomposition;
     _space_home->_memory_decomposition = _space_home->_space_hook->_memory_decomposition;
     _space_home->_iterations_decomposition = _space_home->_space_hook->_iterations_decomposition;
+    _space_home->_memory_limited = _space_home->_space_hook->_memory_limited;
     _space_home->_depth_decomposition = _space_home->_space_hook->_depth_decomposition;
 
 
     _space_home->_problems = _groups_tuples_resolution.size();
 
+    if(_progress) {
+        _progress->problems = _space_home->_problems;
+        _progress->decomposed = (_mode_decomposition == SEQUENTIAL);
+    }
+
     _space_home->_time_max_inactivity = 0;
     _already_timer_max_inactivity_started = false;
 
     //in case of _mode_decomposition
-    if(_master->_group_tuples.empty() && _space_home->_problems == 0) {
+    if(_mode_decomposition != FRONTIER && _mode_decomposition != STREAM && _master->_group_tuples.empty() && _space_home->_problems == 0) {
         n_busy = 0;
         std::cerr << "Problem resolved in sequential dbdfs decomposition !!!\n";
         return;
@@ -444,16 +894,47 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
     _space_home->status(sstat);
     _space_home->_space_hook->status(sstat);
     */
+    //Place the workers on the cpus, each node gets its own copy of the root space
+    Topology topology;
+    if(optSearch.affinity != MyFlatZincOptions::AFFINITY_NONE) {
+        _space_nodes.resize(topology.nodes(), NULL);
+    }
+
+    createPortfolio();
+
     // Create workers
     _workers = static_cast<Worker**>
                (Gecode::heap.ralloc(workers() * sizeof(Worker*)));
 
+    if(counted()) {
+        //Align the counters on a cache line to avoid false sharing between workers
+        _counters_mem = Gecode::heap.ralloc(workers() * sizeof(SolutionCounter) + __CACHE_LINE__);
+        size_t a = reinterpret_cast<size_t>(_counters_mem);
+        a = (a + __CACHE_LINE__ - 1) & ~static_cast<size_t>(__CACHE_LINE__ - 1);
+        _counters = reinterpret_cast<SolutionCounter*>(a);
+        memset(_counters, 0, workers() * sizeof(SolutionCounter));
+    }
+
     // All other workers start with no work and get the entire search tree
     for (unsigned int i=0; i<workers(); i++) {
         _workers[i] = new Worker(NULL,*this, i); //NULL permit the workers to find a space
         _workers[i]->done = false;
+        if(_counters) {
+            _workers[i]->_counter = &_counters[i];
+        }
+        if(optSearch.shards) {
+            _shards.push_back(new SolutionShard());
+            _workers[i]->_shard = _shards.back();
+        }
+        if(_progress) {
+            _workers[i]->_progress = &_progress->worker(i);
+        }
+        if(optSearch.affinity != MyFlatZincOptions::AFFINITY_NONE) {
+            topology.place(i, optSearch.affinity == MyFlatZincOptions::AFFINITY_SCATTER,
+                           _workers[i]->_node, _workers[i]->_cpu);
+        }
 
-        if(_mode_decomposition == SEQUENTIAL) {
+        if(_mode_decomposition == SEQUENTIAL || _mode_decomposition == STREAM) {
             _workers[i]->mode_search = Worker::RESOLUTION;
         } else {
             _workers[i]->mode_search = Worker::DECOMPOSITION;
@@ -463,6 +944,13 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
     //Resize time_subproblems resolved by workers
     _space_home->_time_subproblems_workers->clear();
     _space_home->_time_subproblems_workers->resize(workers());
+    if(_space_home->_memory_workers) {
+        _space_home->_memory_workers->assign(workers(), 0);
+    }
+    if(_space_home->_trace_subproblems_workers) {
+        _space_home->_trace_subproblems_workers->clear();
+        _space_home->_trace_subproblems_workers->resize(workers());
+    }
 
     // Block all workers
     block();
@@ -477,6 +965,7 @@ EPS_DFS::EPS_DFS(Gecode::Space* s, const MySearchOptions& o)
 forceinline void
 EPS_DFS::Worker::reset(Gecode::Space* s, int ngdl) {
     delete cur;
+    disarmRestarts();
     path.reset((s != NULL) ? ngdl : 0);
     d = 0;
     idle = false;
@@ -492,25 +981,353 @@ EPS_DFS::Worker::reset(Gecode::Space* s, int ngdl) {
 /*
  * Engine: search control
  */
+Gecode::Space*
+EPS_DFS::next(void) {
+    Gecode::Space* s = Gecode::Search::Parallel::Engine::next();
+    if(s == NULL && counted()) {
+        //The workers are done or blocked, their counters and shards do not change anymore
+        unsigned long int count = _count_master;
+        for(unsigned int i = 0; _counters && i < workers(); i++) {
+            count += _counters[i].count;
+        }
+        _space_home->_count_solutions = count;
+        if(optSearch.shards) {
+            std::ostream& out = *optSearch.shards->out;
+            if(_shard_master) {
+                _shard_master->flush(out);
+            }
+            for(unsigned int i = 0; i < _shards.size(); i++) {
+                _shards[i]->flush(out);
+            }
+        }
+    }
+    return s;
+}
+
 forceinline void
 EPS_DFS::solution(Gecode::Space* s) {
-    m_search.acquire();
+    _lock_statistics->search.acquire(m_search);
+    pushSolution(s);
+    m_search.release();
+}
+
+forceinline void
+EPS_DFS::pushSolution(Gecode::Space* s) {
     bool bs = signal();
     solutions.push(s);
+    _nb_solutions++;
+    if(optSearch.solution_limit && !_limit_reached && _nb_solutions >= optSearch.solution_limit) {
+        //Enough solutions, the workers drop their work at the next node
+        _timer_limit.start();
+        _limit_reached = true;
+    }
+    if(_progress) {
+        _progress->solutions++;
+    }
     if (bs)
         e_search.signal();
+}
+
+void
+EPS_DFS::commitProblem(Worker* w) {
+    _lock_statistics->search.acquire(m_search);
+
+    unsigned int k = w->_subproblem.id;
+    _det_solutions[k].swap(w->_raced_solutions);
+    _det_done[k] = true;
+    _det_held += _det_solutions[k].size();
+    _space_home->_deterministic_held = std::max(_space_home->_deterministic_held, _det_held);
+
+    while(_det_next < _det_done.size() && _det_done[_det_next]) {
+        std::vector<Gecode::Space*>& held = _det_solutions[_det_next];
+        _det_held -= held.size();
+        for(size_t i = 0; i < held.size(); i++) {
+            if(_limit_reached) {
+                delete held[i];
+            } else {
+                pushSolution(held[i]);
+            }
+        }
+        held.clear();
+        _det_next++;
+    }
+
     m_search.release();
 }
 
 
 
 
+/*
+ * Worker: preparing the subproblems
+ */
+void
+EPS_DFS::Worker::preparePrefix(void) {
+    delete _space_prefix;
+    _space_prefix = NULL;
+
+    if(_run.size() < 2) {
+        return;
+    }
+
+    //Length of the prefix shared by all the tuples of the run (bool variables first),
+    //the subproblems of the run are not contiguous when they are ordered by hardness
+    Gecode::TupleSet& bool_tuples = *_run_tuples_bool;
+    Gecode::TupleSet& int_tuples = *_run_tuples_int;
+    int arity_bool = bool_tuples.tuples() ? bool_tuples.arity() : 0;
+    int arity_int = int_tuples.tuples() ? int_tuples.arity() : 0;
+    unsigned int index_tuple_first = _run.front().first_tuple;
+
+    int prefix_bool = arity_bool;
+    int prefix_int = arity_int;
+    for(size_t k = 0; k < _run.size() && prefix_bool + prefix_int > 0; k++) {
+        for(unsigned int i = _run[k].first_tuple; i < _run[k].first_tuple + _run[k].nb_tuples; i++) {
+            int j = 0;
+            while(j < prefix_bool && bool_tuples[i][j] == bool_tuples[index_tuple_first][j]) {
+                j++;
+            }
+            prefix_bool = j;
+            if(prefix_bool < arity_bool) {
+                prefix_int = 0;
+            }
+            j = 0;
+            while(j < prefix_int && int_tuples[i][j] == int_tuples[index_tuple_first][j]) {
+                j++;
+            }
+            prefix_int = j;
+        }
+    }
+
+    if(prefix_bool + prefix_int == 0) {
+        return;
+    }
+
+    MyFlatZincSpace* space_prefix = static_cast<MyFlatZincSpace*>(_space_root->clone(false));
+    for(int j = 0; j < prefix_bool; j++) {
+        Gecode::rel(*space_prefix, space_prefix->bv[j], Gecode::IRT_EQ, bool_tuples[index_tuple_first][j]);
+    }
+    for(int j = 0; j < prefix_int; j++) {
+        Gecode::rel(*space_prefix, space_prefix->iv[j], Gecode::IRT_EQ, int_tuples[index_tuple_first][j]);
+    }
+
+    //A failed prefix fails every subproblem of the run, they are then solved from the root
+    if(space_prefix->status() == Gecode::SS_FAILED) {
+        delete space_prefix;
+        return;
+    }
+    _space_prefix = space_prefix;
+}
+
+MyFlatZincSpace*
+EPS_DFS::Worker::prepareProblem(const SubProblem& sp) {
+    MyFlatZincSpace* space_resolution = static_cast<MyFlatZincSpace*>((_space_prefix ? _space_prefix : _space_root)->clone(false)); //cloning for independant worker
+
+    //Same posting as the hardness estimates of the subproblems
+    postSubProblem(space_resolution, *_run_tuples_bool, *_run_tuples_int, sp.first_tuple, sp.first_tuple + sp.nb_tuples);
+
+    return space_resolution;
+}
+
+void
+EPS_DFS::Worker::dispatchProblem(void) {
+    _subproblem = _run.front();
+    _run.pop_front();
+
+    if(cur) {
+        delete cur;
+    }
+
+    cur = prepareProblem(_subproblem);
+
+    //_timer_problem was started when the subproblem was taken
+    _dispatch_statistics.add(_timer_problem.stop());
+
+    armRestarts();
+}
+
+void
+EPS_DFS::Worker::armRestarts(void) {
+    disarmRestarts();
+    _cutoff = createWorkerCutoff(engine().optSearch);
+    if(_cutoff == NULL || cur->status(*this) == Gecode::SS_FAILED) {
+        disarmRestarts();
+        return;
+    }
+    _restart_root = cur->clone();
+    _restart_limit = fail + (*_cutoff)();
+    //Depth limit of the nogoods posted at the restarts, 0 if they are disabled
+    path.ngdl(static_cast<int>(engine().opt().nogoods_limit));
+}
+
+void
+EPS_DFS::Worker::disarmRestarts(void) {
+    delete _restart_root;
+    _restart_root = NULL;
+    delete _cutoff;
+    _cutoff = NULL;
+}
+
+void
+EPS_DFS::Worker::restartProblem(void) {
+    delete cur;
+    cur = NULL;
+    if(path.ngdl() > 0) {
+        //The subtrees already refuted are not explored again. The nogoods are
+        //only valid below the root of the subproblem, they are not shared
+        path.post(*_restart_root);
+        nogood += path.ng();
+        if(_restart_root->status(*this) == Gecode::SS_FAILED) {
+            //The nogoods refute the whole subproblem
+            path.reset(0);
+            disarmRestarts();
+            return;
+        }
+    }
+    path.reset(0);
+    d = 0;
+    restart++;
+    //AFC and activity are shared by all the clones, the branchings keep what they learnt
+    cur = _restart_root->clone();
+    _restart_limit = fail + (*_cutoff)();
+    path.ngdl(static_cast<int>(engine().opt().nogoods_limit));
+}
+
+/*
+ * Worker: portfolio
+ */
+void
+EPS_DFS::Worker::dropRaced(void) {
+    STLDeleteElements(&_raced_solutions);
+    engine().lockFindJobResolution();
+    engine()._portfolio->drop(this->id);
+    engine().unlockFindJobResolution();
+}
+
+bool
+EPS_DFS::Worker::finishRaced(void) {
+    bool won = engine().winRaced(this);
+    for(size_t i = 0; i < _raced_solutions.size(); i++) {
+        Gecode::Space* s = _raced_solutions[i];
+        if(!won) {
+            delete s;
+        } else if(engine().counted()) {
+            engine().countSolution(this, s);
+            delete s;
+        } else {
+            engine().solution(s);
+        }
+    }
+    _raced_solutions.clear();
+    return won;
+}
+
+void
+EPS_DFS::createPortfolio(void) {
+    //The streamed subproblems are dropped once dispatched, they cannot be raced
+    if(optSearch.portfolio.empty() || _mode_decomposition == STREAM
+            || optSearch.mode_search == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_GENERATION) {
+        return;
+    }
+    Portfolio* portfolio = new Portfolio(optSearch.portfolio, workers());
+    for(unsigned int g = 0; g < portfolio->groups(); g++) {
+        MyFlatZincSpace* s = static_cast<MyFlatZincSpace*>(_space_home->_space_hook->clone(false));
+        if(!s->createBranchers(portfolio->branching(g))) {
+            std::cerr << "Portfolio ignored, the model has no branching variants\n";
+            delete s;
+            delete portfolio;
+            STLDeleteElements(&_portfolio_spaces);
+            return;
+        }
+        (void) s->status();
+        _portfolio_spaces.push_back(s);
+    }
+    _portfolio = portfolio;
+}
+
+bool
+EPS_DFS::winRaced(Worker* w) {
+    std::vector<unsigned int> losers;
+    lockFindJobResolution();
+    bool won = _portfolio->finish(w->id, losers);
+    for(size_t i = 0; i < losers.size(); i++) {
+        _workers[losers[i]]->_cancelled = true;
+    }
+    if(won && _space_home->_portfolio_wins) {
+        (*_space_home->_portfolio_wins)[_portfolio->group(w->id)]++;
+    }
+    unlockFindJobResolution();
+    return won;
+}
+
+/*
+ * Worker: recursive parallel decomposition
+ */
+void
+EPS_DFS::Worker::expandFrontier(void) {
+    //Lock this instruction because concurrent access to space hook must be protected
+    engine().lockFindJobDecomposition();
+    MyFlatZincSpace* space_for_decomposition = static_cast<MyFlatZincSpace*>(engine()._space_home->_space_hook->clone(false));
+    engine().unlockFindJobDecomposition();
+
+    Frontier& frontier = *engine()._frontier;
+    Prefix p;
+    std::vector<Prefix> children;
+    MemoryPeak memory;
+    memory.start();
+    while(!engine()._limit_reached && frontier.pop(p)) {
+        ExpandStatus status = expandPrefix(space_for_decomposition, p, children);
+        frontier.push(p, status, children);
+        //The root of the worker and the clone of the expanded node
+        memory.sample(2 * engine()._space_home->_memory_space);
+    }
+
+    delete space_for_decomposition;
+
+    engine().lockFindJobResolution();
+
+    engine()._space_home->_memory_decomposition += memory.peak();
+
+    //The last worker publishes the subproblems, the others wait for them in find
+    if(engine()._nb_workers_decomposition_done + 1 < static_cast<int>(engine().workers())) {
+        engine()._nb_workers_decomposition_done++;
+        engine().unlockFindJobResolution();
+        return;
+    }
+
+    engine().unlockFindJobResolution();
+
+    //The frontier is complete, its leaves are probed outside of the lock
+    std::vector<FrontierGroup> groups;
+    std::vector< std::vector<double> > hardness;
+    engine().groupFrontier(groups, hardness);
+
+    engine().lockFindJobResolution();
+
+    engine().addFrontier(this, groups, hardness);
+    engine()._nb_workers_decomposition_done++;
+    engine()._space_home->_time_decomposition = static_cast<unsigned int>(floor(engine()._timer_decomposition.stop()));
+#ifdef _DEBUG
+    fprintf(stderr, "Decomposition of the frontier done => %d problems generated\n", engine()._space_home->_problems);
+#endif
+
+    if(engine()._progress) {
+        engine()._progress->problems = engine()._space_home->_problems;
+        engine()._progress->decomposed = true;
+    }
+
+    engine().unlockFindJobResolution();
+}
+
 /*
  * Worker: finding and stealing working
  */
 forceinline void
 EPS_DFS::Worker::find(void) {
 
+    if(mode_search == DECOMPOSITION && engine()._mode_decomposition == FRONTIER) {
+        expandFrontier();
+        mode_search = RESOLUTION;
+    }
 
     if(mode_search == DECOMPOSITION) {
 
@@ -577,35 +1394,36 @@ EPS_DFS::Worker::find(void) {
         //std::cerr << this->id << "\n";
         //std::cerr << engine()._problems_to_generate_worker.size() << "\n";
         opt.nb_problems = engine()._problems_for_decomposition[this->id];
+        //The workers decompose at the same time, each one gets a share of the budget
+        opt.memory_budget = engine().optSearch.memory_budget / engine().workers();
 
         space_for_decomposition->_nodes_decomposition = 0;
         space_for_decomposition->_fails_decomposition = 0;
         space_for_decomposition->_memory_decomposition = 0;
         space_for_decomposition->_iterations_decomposition = 0;
+        space_for_decomposition->_memory_limited = 0;
         space_for_decomposition->_depth_decomposition = 0;
 
         this->decomposeProblems(space_for_decomposition, opt);
 
+        //Estimate the hardness on the private space, outside of the lock
+        std::vector<double> hardness;
+        if(_group_tuples.size() && engine().optSearch.order == MyFlatZincOptions::ORDER_LPT) {
+            estimateHardness(space_for_decomposition, _group_tuples, *_tuples_bool_ndi, *_tuples_int_ndi,
+                             engine().optSearch.probe_nodes, hardness);
+        }
+
         engine().lockFindJobResolution();
 
         if(_group_tuples.size()) {
 
-            engine()._groups_tuples_resolution.insert(engine()._groups_tuples_resolution.end(), _group_tuples.begin(), _group_tuples.end());
-            engine()._tuples_bool_resolution.push_back(new Gecode::TupleSet(*_tuples_bool_ndi));
-            engine()._tuples_int_resolution.push_back(new Gecode::TupleSet(*_tuples_int_ndi));
-
-            if(!engine()._tuples_bool_resolution.back()->finalized()) {
-                engine()._tuples_bool_resolution.back()->finalize();
-            }
-
-            if(!engine()._tuples_int_resolution.back()->finalized()) {
-                engine()._tuples_int_resolution.back()->finalize();
-            }
+            engine().addProblems(this, hardness);
 
             engine()._space_home->_nodes_decomposition += space_for_decomposition->_nodes_decomposition;
             engine()._space_home->_fails_decomposition += space_for_decomposition->_fails_decomposition;
             engine()._space_home->_memory_decomposition += space_for_decomposition->_memory_decomposition;
             engine()._space_home->_iterations_decomposition += space_for_decomposition->_iterations_decomposition;
+            engine()._space_home->_memory_limited += space_for_decomposition->_memory_limited;
 
             if(engine()._space_home->_depth_decomposition < space_for_decomposition->_depth_decomposition) {
                 engine()._space_home->_depth_decomposition = space_for_decomposition->_depth_decomposition;
@@ -616,6 +1434,11 @@ EPS_DFS::Worker::find(void) {
 
         engine()._nb_workers_decomposition_done++;
 
+        if(engine()._progress) {
+            engine()._progress->problems = engine()._space_home->_problems;
+            engine()._progress->decomposed = (engine()._nb_workers_decomposition_done == engine().workers());
+        }
+
 #ifdef _DEBUG
         if(_group_tuples.size()) {
             fprintf(stderr, "Decomposition by worker %d done => %d problems generated\n", this->id, _group_tuples.size());
@@ -644,9 +1467,71 @@ EPS_DFS::Worker::find(void) {
         mode_search = RESOLUTION;
     }
 
+    //Next subproblem of the run taken at the last dispatch
+    if(!_run.empty() && !engine()._limit_reached) {
+        _timer_problem.start();
+        idle = false;
+        d = 0;
+        dispatchProblem();
+        return;
+    }
+
     engine().lockFindJobResolution();
 
-    if(engine()._current_problem_resolution < engine()._groups_tuples_resolution.size()) {
+    engine()._lock_statistics->dispatch.merge(_dispatch_statistics);
+    _dispatch_statistics = DurationStatistics();
+
+    //The last run is solved
+    if(_run_tuples_bool) {
+        engine().releaseProblems(_run_group, _run_size);
+        _run_tuples_bool = NULL;
+        _run_tuples_int = NULL;
+    }
+
+    //Out of subproblems, generate the next batch of the stream
+    if(engine()._mode_decomposition == STREAM && !engine()._limit_reached
+            && engine()._current_problem_resolution == static_cast<int>(engine()._subproblems.size())
+            && engine()._nb_workers_decomposition_done < static_cast<int>(engine().workers())) {
+        engine().unlockFindJobResolution();
+        engine().refillStream(this);
+        engine().lockFindJobResolution();
+    }
+
+    //Race the next subproblem with the branching of the group of the worker
+    int raced = -1;
+    if(engine()._portfolio && !engine()._limit_reached) {
+        raced = engine()._portfolio->take(this->id, engine()._subproblems.size());
+    }
+
+    if(raced >= 0) {
+        _timer_problem.start();
+        idle = false;
+        d = 0;
+        _cancelled = false;
+
+        if(_space_root == NULL) {
+            _space_root = static_cast<MyFlatZincSpace*>(engine()._portfolio_spaces[engine()._portfolio->group(this->id)]->clone(false));
+        }
+
+        const SubProblem& sp = engine()._subproblems[raced];
+        _run_tuples_bool = engine()._tuples_bool_resolution[sp.group];
+        _run_tuples_int = engine()._tuples_int_resolution[sp.group];
+        _run_group = sp.group;
+        _run.push_back(sp);
+        _run_size = 1;
+
+        if(_progress) {
+            _progress->idle = false;
+        }
+
+        engine().unlockFindJobResolution();
+
+        preparePrefix();
+        dispatchProblem();
+        return;
+
+    } else if(!engine()._portfolio && !engine()._limit_reached
+              && engine()._current_problem_resolution < engine()._groups_tuples_resolution.size()) {
 
         _timer_problem.start();
 
@@ -661,9 +1546,11 @@ EPS_DFS::Worker::find(void) {
             }
 
 
-            unsigned int index_tuple_last = engine()._current_index_tuple_resolution + engine()._groups_tuples_resolution[engine()._current_problem_resolution];
+            _subproblem = engine()._subproblems[engine()._current_problem_resolution];
+            unsigned int index_tuple_first = _subproblem.first_tuple;
+            unsigned int index_tuple_last = _subproblem.first_tuple + _subproblem.nb_tuples;
 
-            Gecode::TupleSet& bool_tuples = *engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution];
+            Gecode::TupleSet& bool_tuples = *engine()._tuples_bool_resolution[_subproblem.group];
             int nb_bool_tuples = bool_tuples.tuples();
             if(nb_bool_tuples) {
                 int arity_bool = bool_tuples.arity();
@@ -677,7 +1564,7 @@ EPS_DFS::Worker::find(void) {
                 //std::cerr << "]\n";
                 os << "\n";
 
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
+                for(unsigned int i = index_tuple_first; i < index_tuple_last; i++) {
                     Gecode::IntArgs tuple(arity_bool, bool_tuples[i]);
 
                     os << "t ";
@@ -691,7 +1578,7 @@ EPS_DFS::Worker::find(void) {
 
             }
 
-            Gecode::TupleSet& int_tuples = *engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution];
+            Gecode::TupleSet& int_tuples = *engine()._tuples_int_resolution[_subproblem.group];
             int nb_int_tuples = int_tuples.tuples();
             if(nb_int_tuples) {
                 int arity_int = int_tuples.arity();
@@ -705,7 +1592,7 @@ EPS_DFS::Worker::find(void) {
                 //std::cerr << "]\n";
                 os << "\n";
 
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
+                for(unsigned int i = index_tuple_first; i < index_tuple_last; i++) {
                     Gecode::IntArgs tuple(arity_int, int_tuples[i]);
 
                     os << "t ";
@@ -724,189 +1611,73 @@ EPS_DFS::Worker::find(void) {
             }
 
 
-            if(index_tuple_last+1 > std::max(nb_int_tuples, nb_bool_tuples)) {
-
-                engine()._current_index_tuple_resolution = 0;
-                engine()._current_index_group_tuple_resolution++;
+            engine()._current_problem_resolution++;
+            engine().releaseProblems(_subproblem.group, 1);
 
-            } else {
-                engine()._current_index_tuple_resolution = index_tuple_last;
+            if(engine()._progress) {
+                engine()._progress->dispatched = engine()._problems_base + engine()._current_problem_resolution;
             }
 
-            engine()._current_problem_resolution++;
-
             os.close();
             idle = true;
             engine()._current_problem++;
 
+            if(_progress) {
+                _progress->problems++;
+            }
+
         } else {
             idle = false;
             d = 0;
 
-            MyFlatZincSpace* space_resolution = static_cast<MyFlatZincSpace*>(engine()._space_home->clone(false)); //cloning for independant worker
-
-
-
-            unsigned int index_tuple_last = engine()._current_index_tuple_resolution + engine()._groups_tuples_resolution[engine()._current_problem_resolution];
-
-            Gecode::TupleSet& bool_tuples = *engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution];
-            int nb_bool_tuples = bool_tuples.tuples();
-            if(nb_bool_tuples) {
-                int arity_bool = bool_tuples.arity();
-                Gecode::TupleSet tuples;
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
-                    Gecode::IntArgs tuple(arity_bool, bool_tuples[i]);
-
-                    /*
-                    std::cerr << "tuple[";
-                    for(int j = 0; j < tuple.size(); j++) {
-                    	std::cerr << tuple[j] << ", ";
-                    }
-                    std::cerr << "]\n";
-                    */
-                    tuples.add(tuple);
-
-                }
-                tuples.finalize();
-
-                Gecode::BoolVarArgs vars(arity_bool);
-                //std::cerr << "vars[";
-                for(int i = 0; i < arity_bool; i++) {
-                    vars[i] = space_resolution->bv[i];
-                    //    std::cerr << j << ", ";
-                }
-
-                //std::cerr << "]\n";
-                //std::cerr << "decision variables : " << s->args_iv.size() << std::endl;
-                //if(nb_bool_tuples == 1) {
-                //    for(int i = 0; i < arity_bool; i++) {
-                //        Gecode::rel(*space_resolution, vars[i], Gecode::IRT_EQ, tuples[0][i]);
-                //    }
-                //
-                //} else {
-                Gecode::extensional(*space_resolution, vars, tuples, Gecode::EPK_DEF, Gecode::ICL_DOM);
-                //}
-            }
-            //std::cerr << "Problem " << engine()._current_problem_resolution << "\n";
-
-            Gecode::TupleSet& int_tuples = *engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution];
-            int nb_int_tuples = int_tuples.tuples();
-            if(nb_int_tuples) {
-                int arity_int = int_tuples.arity();
-
-                Gecode::TupleSet tuples;
-                for(unsigned int i = engine()._current_index_tuple_resolution; i < index_tuple_last; i++) {
-                    Gecode::IntArgs tuple(arity_int, int_tuples[i]);
-                    /*
-                    std::cerr << "tuple[";
-                    for(int j = 0; j < tuple.size(); j++) {
-                    	std::cerr << tuple[j] << ", ";
-                    }
-                    std::cerr << "]\n";
-                    */
-                    tuples.add(tuple);
-                }
-                tuples.finalize();
-                /*
-                const int nb_tuples = tuples.tuples();
-
-                int* values_vertical = new int[nb_tuples];
-                for(unsigned int i = 0; i < tuples.arity(); i++) {
-
-                	for(unsigned int j = 0; j < nb_tuples; j++) {
-                		values_vertical[j] = tuples[j][i];
-                	}
-                	Gecode::IntSet values(values_vertical, nb_tuples);
-
-                	//Gecode::IntVar x(*space_resolution, values);
-
-                	Gecode::dom(*space_resolution, space_resolution->iv[i], values);
-
-                	//std::cerr << space_resolution->iv[i] << " (before) => ";
-                	//space_resolution->iv[i].update(*space_resolution, false, x);
-
-
-                	//Gecode::rel(*space_resolution, space_resolution->iv[i], Gecode::IRT_GQ, space_resolution->iv[i].min());
-                	//Gecode::rel(*space_resolution, space_resolution->iv[i], Gecode::IRT_LQ, space_resolution->iv[i].max());
-                }
-                delete [] values_vertical;
-                */
-                //for(unsigned int i = 0; i < tuples.arity(); i++) {
-                //    std::cerr << space_resolution->iv[i] << " (after)\n";
-                //}
-
-
-                Gecode::IntVarArgs vars(arity_int);
-                //std::cerr << "iv[";
-                for(int i = 0; i < arity_int; i++) {
-                    vars[i] = space_resolution->iv[i];
-                    //    std::cerr << i << ", ";
-                }
-
-                //std::cerr << "]\n\n";
-
-                //std::cerr << "decision variables : " << s->args_iv.size() << std::endl;
-                //if(nb_int_tuples == 1) {
-                //    for(int i = 0; i < arity_int; i++) {
-                //        Gecode::rel(*space_resolution, vars[i], Gecode::IRT_EQ, tuples[0][i]);
-                //    }
-
-                //} else {
-                Gecode::extensional(*space_resolution, vars, tuples, Gecode::EPK_DEF, Gecode::ICL_DOM);
-                //}
+            //The first dispatch prepares the root space of the worker, the
+            //following clones only touch this copy and are done outside the lock
+            if(_space_root == NULL) {
+                _space_root = static_cast<MyFlatZincSpace*>(engine().prototype(_node)->clone(false));
             }
 
-            //Gecode::branch(*s, s->iv, Gecode::INT_VAR_NONE(), Gecode::INT_VAL_MIN());
-            //Gecode::branch(*s, s->iv, Gecode::TieBreak<Gecode::IntVarBranch>(Gecode::INT_VAR_NONE()), Gecode::INT_VALUES_MIN());
-            /* Problem with args :S
-            if(s->args_iv.size()) {
-            	for(int i = 0; i < s->args_iv.size(); i++) {
-            		Gecode::branch(*s, s->args_iv[i], s->branch_var_iv[i], s->branch_val_iv[i]);
-            	}
-            }
-            if(s->args_bv.size()) {
-            	Gecode::branch(*s, s->args_bv, s->branch_var_bv, s->branch_val_bv);
+            //Take a chunk of consecutive subproblems of the same group, siblings of
+            //the decomposition share the propagation of their common prefix
+            const std::vector<SubProblem>& subproblems = engine()._subproblems;
+            unsigned int chunk = engine().chunkSize(this);
+            unsigned int group = subproblems[engine()._current_problem_resolution].group;
+            _run_tuples_bool = engine()._tuples_bool_resolution[group];
+            _run_tuples_int = engine()._tuples_int_resolution[group];
+            _run_group = group;
+            do {
+                _run.push_back(subproblems[engine()._current_problem_resolution]);
+                engine()._current_problem_resolution++;
+                engine()._current_problem++;
+            } while(_run.size() < chunk
+                    && engine()._current_problem_resolution < static_cast<int>(subproblems.size())
+                    && subproblems[engine()._current_problem_resolution].group == group);
+            _run_size = _run.size();
+
+            if(engine()._progress) {
+                engine()._progress->dispatched = engine()._problems_base + engine()._current_problem_resolution;
             }
-            if(s->args_sv.size()) {
-            	Gecode::branch(*s, s->args_sv, s->branch_var_sv, s->branch_val_sv);
-            }
-            if(s->args_fv.size()) {
-            	Gecode::branch(*s, s->args_fv, s->branch_var_fv, s->branch_val_fv);
-            }
-            */
-
-            if(index_tuple_last+1 > std::max(nb_int_tuples, nb_bool_tuples)) {
-                //delete engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution];
-                //delete engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution];
 
-                //engine()._tuples_bool_resolution[engine()._current_index_group_tuple_resolution] = NULL;
-                //engine()._tuples_int_resolution[engine()._current_index_group_tuple_resolution] = NULL;
-
-                engine()._current_index_tuple_resolution = 0;
-                engine()._current_index_group_tuple_resolution++;
-
-            } else {
-                engine()._current_index_tuple_resolution = index_tuple_last;
-            }
-
-            engine()._current_problem_resolution++;
-
-
-            if(cur) {
-                delete cur;
+            if(_progress) {
+                _progress->idle = false;
             }
 
-            cur = space_resolution;
+            engine().unlockFindJobResolution();
 
-            engine()._current_problem++;
+            preparePrefix();
+            dispatchProblem();
+            return;
         }
 
-    } else if(engine()._nb_workers_decomposition_done == engine().workers()) {
+    } else if(engine()._limit_reached || engine()._nb_workers_decomposition_done == engine().workers()) {
 
         // Report that worker is idle
         if(!done) {
             engine().idle();
 
+            if(_progress) {
+                _progress->idle = true;
+            }
+
 
             done = true;
 
@@ -947,6 +1718,15 @@ EPS_DFS::statistics(void) const {
  */
 void
 EPS_DFS::Worker::run(void) {
+    if(_cpu >= 0 && !pinThread(_cpu)) {
+        //The worker runs unpinned, so it clones its subproblems from the root space
+        std::cerr << "Warning: worker " << id << " could not be pinned on cpu " << _cpu << std::endl;
+        _node = -1;
+        _cpu = -1;
+    }
+    //Allocations of the worker come from its own arena (jemalloc only)
+    allocatorBindThread();
+    _memory.start();
     // Peform initial delay, if not first worker
     //if (this != engine().worker(0))
     //    Gecode::Support::Thread::sleep(Gecode::Search::Config::initial_delay);
@@ -977,6 +1757,34 @@ EPS_DFS::Worker::run(void) {
             // Perform exploration work
         {
             if(!done) {
+                if(engine()._limit_reached && !idle) {
+                    //Enough solutions, the subproblem and the rest of the run are dropped
+                    delete cur;
+                    cur = NULL;
+                    path.reset(0);
+                    _run.clear();
+                    disarmRestarts();
+                    if(engine()._portfolio) {
+                        dropRaced();
+                    } else {
+                        STLDeleteElements(&_raced_solutions);
+                    }
+                    idle = true;
+                    engine().limitStopped();
+                }
+                if(_cancelled && !idle) {
+                    //Another branching finished the subproblem first
+                    delete cur;
+                    cur = NULL;
+                    path.reset(0);
+                    disarmRestarts();
+                    dropRaced();
+                    idle = true;
+                }
+                if(_restart_root && !idle && fail >= _restart_limit) {
+                    //Heavy tailed subproblem, solve it again with what the heuristics learnt
+                    restartProblem();
+                }
                 if (idle) {
                     // Try to find new work
                     find();
@@ -987,6 +1795,9 @@ EPS_DFS::Worker::run(void) {
                         engine().stop();
                     } else {
                         node++;
+                        if(_progress) {
+                            _progress->nodes = node;
+                        }
                         switch (cur->status(*this)) {
                         case Gecode::SS_FAILED:
                             fail++;
@@ -994,6 +1805,30 @@ EPS_DFS::Worker::run(void) {
                             cur = NULL;
                             break;
                         case Gecode::SS_SOLVED: {
+                            //A restart would find the reported solutions again
+                            disarmRestarts();
+                            if(engine()._portfolio || (engine().optSearch.deterministic && !_counter)) {
+                                //Reported only if the group of the worker wins the subproblem,
+                                //or once the subproblems before it are committed
+                                (void) cur->choice();
+                                _raced_solutions.push_back(cur->clone(false));
+                                delete cur;
+                                cur = NULL;
+                                if(engine()._portfolio == NULL && engine().optSearch.solution_limit
+                                        && _raced_solutions.size() >= engine().optSearch.solution_limit) {
+                                    //The following solutions of the subproblem are never reported
+                                    path.reset(0);
+                                }
+                                break;
+                            }
+                            if(_counter) {
+                                //Only counted (and printed), neither cloned nor queued
+                                engine().countSolution(this, cur);
+                                delete cur;
+                                cur = NULL;
+                                break;
+                            }
+
                             // Deletes all pending branchers
                             (void) cur->choice();
 
@@ -1017,6 +1852,8 @@ EPS_DFS::Worker::run(void) {
                             }
                             const Gecode::Choice* ch = path.push(*this,cur,c);
                             cur->commit(*ch,0);
+                            //Clones of the path, the current space, the root and the prefix of the worker
+                            _memory.sample((path.entries() / engine().opt().c_d + 4) * engine()._space_home->_memory_space);
                         }
                         break;
                         default:
@@ -1027,9 +1864,25 @@ EPS_DFS::Worker::run(void) {
                     cur = path.recompute(d,engine().opt().a_d,*this);
                 } else {
                     idle = true;
+                    disarmRestarts();
+
+                    if(engine().optSearch.deterministic) {
+                        engine().commitProblem(this);
+                    }
+                    //A raced subproblem is only accounted by the group which wins it
+                    if(!engine()._portfolio || finishRaced()) {
+                        //add timer for finished a subproblem
+                        double time_problem = _timer_problem.stop();
+                        engine().notifyFinishedSubproblem(this->id, _subproblem, time_problem);
+                        if(engine()._space_home->_memory_workers) {
+                            (*engine()._space_home->_memory_workers)[this->id] = _memory.peak();
+                        }
+                        _problem_statistics.add(time_problem);
 
-                    //add timer for finished a subproblem
-                    engine().notifyFinishedSubproblem(this->id, _timer_problem.stop());
+                        if(_progress) {
+                            _progress->problems++;
+                        }
+                    }
                     //path.reset();
                 }
             }
@@ -1042,6 +1895,21 @@ EPS_DFS::Worker::run(void) {
 }
 
 
+/*
+ * Engine: NUMA prototypes
+ */
+MyFlatZincSpace*
+EPS_DFS::prototype(int node) {
+    if(node < 0) {
+        return _space_home;
+    }
+    //The first worker of the node clones it, so its memory is local to the node
+    if(_space_nodes[node] == NULL) {
+        _space_nodes[node] = static_cast<MyFlatZincSpace*>(_space_home->clone(false));
+    }
+    return _space_nodes[node];
+}
+
 /*
  * Termination and deletion
  */
@@ -1051,10 +1919,31 @@ EPS_DFS::~EPS_DFS(void) {
         Gecode::heap.rfree(_workers);
     }
 
+    if(_progress) {
+        _progress->stop();
+        delete _progress;
+    }
+
     if(_master) {
         delete _master;
     }
 
+    delete _frontier;
+    delete _stream;
+
+    if(_counters_mem) {
+        Gecode::heap.rfree(_counters_mem);
+    }
+    delete _shard_master;
+    STLDeleteElements(&this->_shards);
+    delete _portfolio;
+    STLDeleteElements(&this->_portfolio_spaces);
+
+    for(size_t i = 0; i < _det_solutions.size(); i++) {
+        STLDeleteElements(&_det_solutions[i]);
+    }
+
+    STLDeleteElements(&this->_space_nodes);
     STLDeleteElements(&this->_tuples_bool_resolution);
     STLDeleteElements(&this->_tuples_int_resolution);
 }
@@ -1091,6 +1980,10 @@ EPS_DFS::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o)
     //Use DFS for bounded dfs
     BoundedDFS dbdfs(NULL, opt);
 
+    MemoryPeak memory;
+    memory.start();
+    size_t memory_space = engine()._space_home->_memory_space;
+
 
     s->_iterations_decomposition = 0;
 
@@ -1231,7 +2124,12 @@ EPS_DFS::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o)
 
                 if(isSolution) {
 
-                    engine().solution(solution);
+                    if(engine().counted()) {
+                        engine().countSolution(this, solution);
+                        delete solution;
+                    } else {
+                        engine().solution(solution);
+                    }
                     nb_solutions++;
 
                 } else {
@@ -1284,6 +2182,14 @@ EPS_DFS::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o)
                     delete solution;
                 }
 
+                //The space of the level and the solution
+                memory.sample(2 * memory_space);
+
+                //Enough solutions, the decomposition is dropped
+                if(engine()._limit_reached) {
+                    break;
+                }
+
                 solution = static_cast<MyFlatZincSpace*>(dbdfs.next());
             }
         }
@@ -1299,6 +2205,11 @@ EPS_DFS::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o)
             _tuples_bool_ndi->finalize();
         }
 
+        //The tuples of the level and the spaces of the bounded search
+        memory.sample(tupleSetMemory(*_tuples_bool_ndi) + tupleSetMemory(*_tuples_int_ndi)
+                      + (stat.depth / opt.c_d + 2) * memory_space);
+        s->_memory_decomposition = memory.peak();
+
 
         if(_tuples_int_ndi && _tuples_bool_ndi) {
             product_domain = _tuples_bool_ndi->tuples() ? _tuples_bool_ndi->tuples() : _tuples_int_ndi->tuples();
@@ -1310,6 +2221,11 @@ EPS_DFS::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o)
 
         s->_depth_decomposition = level;
 
+        if(engine()._limit_reached) {
+            engine().limitStopped();
+            product_domain = 0;
+        }
+
         if(product_domain == 0) {
             delete _tuples_int_ndi;
             _tuples_int_ndi = NULL;
@@ -1353,6 +2269,13 @@ EPS_DFS::Worker::decomposeProblems(MyFlatZincSpace* s, const MySearchOptions& o)
 
             _group_tuples.resize(newP, 1);
 
+            //STOP
+            break;
+        } else if(opt.memory_budget && 2 * memory.peak() > opt.memory_budget) {
+            //The next level would at least double the memory, the tuples of this one are the subproblems
+            _group_tuples.resize(product_domain, 1);
+            s->_memory_limited++;
+
             //STOP
             break;
         } else if(level == nb_decision_variables) {
@@ -1810,12 +2733,30 @@ eps_dfs_to_engine(Gecode::Space* s, const MySearchOptions& o) {
     to.c_d = o.c_d;
     to.clone = o.clone;
     to.stop = o.stop;
-    to.cutoff = to.cutoff;
+    to.cutoff = o.cutoff;
     to.nb_problems = o.nb_problems;
     to.mode_decomposition = o.mode_decomposition;
     to.mode_search = o.mode_search;
     to.obj_file = o.obj_file;
+    to.progress_interval = o.progress_interval;
+    to.progress_file = o.progress_file;
     to.first_level = o.first_level;
+    to.order = o.order;
+    to.probe_nodes = o.probe_nodes;
+    to.affinity = o.affinity;
+    to.chunk_size = o.chunk_size;
+    to.chunk = o.chunk;
+    to.chunk_time = o.chunk_time;
+    to.memory_budget = o.memory_budget;
+    to.stream_batch = o.stream_batch;
+    to.solution_limit = o.solution_limit;
+    to.count_only = o.count_only;
+    to.shards = o.shards;
+    to.restart = o.restart;
+    to.restart_scale = o.restart_scale;
+    to.restart_base = o.restart_base;
+    to.portfolio = o.portfolio;
+    to.deterministic = o.deterministic;
     //std::cerr << o.nb_problems << std::endl;
     //std::cerr << to.nb_problems << std::endl;
 
@@ -0,0 +1,552 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* eps_lns.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <gecode/search/parallel/engine.hh>
+#include <gecode/int.hh>
+
+#include <vector>
+#include <algorithm>
+
+#include "search.h"
+#include "flatzinc.h"
+#include "allocator.h"
+
+namespace Parallel {
+
+/// Parallel large neighbourhood search around an incumbent shared by the workers
+class EPS_LNS : public Gecode::Search::Parallel::Engine {
+protected:
+    class Worker : public Gecode::Search::Parallel::Engine::Worker {
+    public:
+        unsigned int id;
+        ///control if the worker is done
+        bool done;
+        /// Incumbent the current neighbourhood is relaxed around (NULL before the first solution)
+        MyFlatZincSpace* best;
+        /// Improvements of the incumbent known by the worker
+        unsigned long int _version;
+        /// Root space of the worker, the neighbourhoods are cloned from it
+        MyFlatZincSpace* _space_root;
+        /// Failures after which the current neighbourhood is abandoned (0 for none)
+        unsigned long int _limit;
+        /// Variables fixed by the current neighbourhood
+        unsigned int _fixed;
+        /// Neighbourhoods since the last improvement of the incumbent, each one relaxes one more percent
+        unsigned int _stale;
+        /// Variables relaxed by the current neighbourhood
+        std::vector<bool> _relaxed;
+        /// Random choices of the neighbourhoods
+        Gecode::Support::RandomGenerator _rnd;
+
+        /// Initialize with engine \a e
+        Worker(EPS_LNS& e, unsigned int id_worker);
+        /// Provide access to engine
+        EPS_LNS& engine(void) const;
+        /// Start execution of worker
+        virtual void run(void);
+        /// Choose the relaxed variables of the next neighbourhood
+        void choose(void);
+        /// Start the next neighbourhood around the incumbent
+        void relax(void);
+        void reset(Gecode::Space* s);
+        /// Destructor
+        virtual ~Worker(void);
+    };
+    /// Array of worker references
+    Worker** _workers;
+    /// space generated by parsing flatzinc file
+    MyFlatZincSpace* _space_home;
+
+    MySearchOptions optSearch;
+
+    /// Incumbent shared by the workers (protected by m_search)
+    Gecode::Space* best;
+    /// Improvements of the incumbent
+    unsigned long int _version;
+    /// Integer variables the neighbourhoods relax or fix (all but the objective)
+    std::vector<int> _candidates;
+    /// Set when a search without fixed variables is exhausted, the incumbent is optimal
+    volatile bool _proven;
+    /// Mutex for the clones of the root space
+    Gecode::Support::Mutex m_root;
+
+public:
+    /// Provide access to worker \a i
+    Worker* worker(unsigned int i) const;
+
+    /// \name Search control
+    //@{
+    /// Report solution \a s of worker \a w, kept if it improves the incumbent
+    void solution(Worker* w, Gecode::Space* s);
+    /// Give \a w the incumbent if it improved since its last neighbourhood, and account a neighbourhood
+    void neighbourhood(Worker* w);
+    /// Report that the search is complete
+    void prove(void) {
+        _proven = true;
+    }
+    //@}
+
+    /// Reset engine to restart at space \a s
+    virtual void reset(Gecode::Space* s) {
+        // Grab wait lock for reset
+        m_wait_reset.acquire();
+        // Release workers for reset
+        release(C_RESET);
+        // Wait for reset cycle started
+        e_reset_ack_start.wait();
+        // All workers are marked as busy again
+        delete best;
+        best = NULL;
+        _version = 0;
+        _proven = false;
+        n_busy = workers();
+        for (unsigned int i=0; i<workers(); i++)
+            worker(i)->reset(NULL);
+        delete s;
+        // Block workers again to ensure invariant
+        block();
+        // Release reset lock
+        m_wait_reset.release();
+        // Wait for reset cycle stopped
+        e_reset_ack_stop.wait();
+    }
+
+    /// \name Engine interface
+    //@{
+    /// Initialize for space \a s with options \a o
+    EPS_LNS(Gecode::Space* s, const MySearchOptions& o);
+    /// Return statistics
+    virtual Gecode::Search::Statistics statistics(void) const;
+    /// Return no-goods
+    virtual Gecode::NoGoods& nogoods(void);
+    /// Destructor
+    virtual ~EPS_LNS(void);
+    //@}
+};
+
+
+/*
+ * Engine: basic access routines
+ */
+forceinline EPS_LNS&
+EPS_LNS::Worker::engine(void) const {
+    return static_cast<EPS_LNS&>(_engine);
+}
+forceinline EPS_LNS::Worker*
+EPS_LNS::worker(unsigned int i) const {
+    return _workers[i];
+}
+
+/*
+ * Engine: initialization
+ */
+forceinline
+EPS_LNS::Worker::Worker(EPS_LNS& e, unsigned int id_worker)
+    : Gecode::Search::Parallel::Engine::Worker(NULL,e),
+      id(id_worker),
+      done(false),
+      best(NULL),
+      _version(0),
+      _space_root(NULL),
+      _limit(0),
+      _fixed(0),
+      _stale(0),
+      _rnd(e.optSearch.seed + id_worker + 1) {
+    idle = true;
+}
+
+EPS_LNS::EPS_LNS(Gecode::Space* s, const MySearchOptions& o)
+    : Gecode::Search::Parallel::Engine(o),
+      _workers(NULL),
+      _space_home(static_cast<MyFlatZincSpace*>(s)),
+      optSearch(o),
+      best(NULL),
+      _version(0),
+      _proven(false) {
+
+    _space_home->_lns_neighbourhoods = 0;
+    _space_home->_lns_improvements = 0;
+
+    for(int i = 0; i < _space_home->iv.size(); i++) {
+        if(i != _space_home->optVar()) {
+            _candidates.push_back(i);
+        }
+    }
+
+    // Create workers
+    _workers = static_cast<Worker**>
+               (Gecode::heap.ralloc(workers() * sizeof(Worker*)));
+    for (unsigned int i=0; i<workers(); i++) {
+        _workers[i] = new Worker(*this, i);
+    }
+
+    // Block all workers
+    block();
+    // Create and start threads
+    for (unsigned int i=0; i<workers(); i++)
+        Gecode::Support::Thread::run(_workers[i]);
+}
+
+forceinline void
+EPS_LNS::Worker::reset(Gecode::Space* s) {
+    delete cur;
+    cur = NULL;
+    delete best;
+    best = NULL;
+    _version = 0;
+    _stale = 0;
+    path.reset(0);
+    d = 0;
+    idle = true;
+    done = false;
+    delete s;
+    Gecode::Search::Worker::reset();
+}
+
+
+/*
+ * Engine: search control
+ */
+void
+EPS_LNS::solution(Worker* w, Gecode::Space* s) {
+    m_search.acquire();
+
+    MyFlatZincSpace* fz = static_cast<MyFlatZincSpace*>(s);
+    fz->stampSolution(w->id, -1);
+    if(best) {
+        //Another worker may have improved the incumbent since the neighbourhood was relaxed
+        MyFlatZincSpace* fb = static_cast<MyFlatZincSpace*>(best);
+        bool better = fz->method() == MyFlatZincSpace::MIN ?
+                      fz->iv[fz->optVar()].max() < fb->iv[fb->optVar()].max()
+                      : fz->iv[fz->optVar()].min() > fb->iv[fb->optVar()].min();
+        if(!better) {
+            m_search.release();
+            delete s;
+            return;
+        }
+    }
+
+    delete best;
+    best = s->clone(false);
+    delete s;
+    _version++;
+    _space_home->_lns_improvements++;
+
+    bool bs = signal();
+    solutions.push(best->clone(false));
+    if (bs) {
+        e_search.signal();
+    }
+
+    m_search.release();
+}
+
+void
+EPS_LNS::neighbourhood(Worker* w) {
+    m_search.acquire();
+    if(w->_version != _version) {
+        delete w->best;
+        w->best = static_cast<MyFlatZincSpace*>(best->clone(false));
+        w->_version = _version;
+        w->_stale = 0;
+    } else if(w->best) {
+        w->_stale++;
+    }
+    if(w->best) {
+        _space_home->_lns_neighbourhoods++;
+    }
+    m_search.release();
+}
+
+
+/*
+ * Worker: neighbourhoods
+ */
+void
+EPS_LNS::Worker::choose(void) {
+    const std::vector<int>& candidates = engine()._candidates;
+    unsigned int n = candidates.size();
+    //Widened until the whole incumbent is relaxed, the search is then complete and can prove it optimal
+    unsigned long int relax = std::min(100ul, static_cast<unsigned long int>(engine().optSearch.lns_relax) + _stale);
+    unsigned int k = std::min(n, static_cast<unsigned int>((n * relax + 99) / 100));
+    _relaxed.assign(n, false);
+    if(k == 0) {
+        return;
+    }
+    if(engine().optSearch.lns_neighbourhood == MyFlatZincOptions::LNS_WINDOW) {
+        //Variables declared together are usually linked by the constraints
+        unsigned int start = _rnd(n);
+        for(unsigned int j = 0; j < k; j++) {
+            _relaxed[(start + j) % n] = true;
+        }
+    } else {
+        //Partial shuffle of the candidates, the first k are relaxed
+        std::vector<unsigned int> order(n);
+        for(unsigned int j = 0; j < n; j++) {
+            order[j] = j;
+        }
+        for(unsigned int j = 0; j < k; j++) {
+            std::swap(order[j], order[j + _rnd(n - j)]);
+            _relaxed[order[j]] = true;
+        }
+    }
+}
+
+void
+EPS_LNS::Worker::relax(void) {
+    delete cur;
+    cur = NULL;
+    path.reset(0);
+    d = 0;
+
+    if(_space_root == NULL) {
+        //Cloning modifies the original space, the workers take turns
+        engine().m_root.acquire();
+        _space_root = static_cast<MyFlatZincSpace*>(engine()._space_home->clone(false));
+        engine().m_root.release();
+    }
+
+    engine().neighbourhood(this);
+    if(best == NULL && id != 0) {
+        //The first worker searches the initial solution, the others wait for it
+        Gecode::Support::Thread::sleep(1);
+        return;
+    }
+
+    MyFlatZincSpace* s = static_cast<MyFlatZincSpace*>(_space_root->clone());
+    _fixed = 0;
+    _limit = 0;
+    if(best) {
+        choose();
+        const std::vector<int>& candidates = engine()._candidates;
+        for(size_t j = 0; j < candidates.size(); j++) {
+            int i = candidates[j];
+            if(!_relaxed[j] && best->iv[i].assigned()) {
+                Gecode::rel(*s, s->iv[i], Gecode::IRT_EQ, best->iv[i].val());
+                _fixed++;
+            }
+        }
+        s->constrain(*best);
+        //Without fixed variables the neighbourhood is searched to the end
+        _limit = _fixed > 0 ? fail + std::max(engine().optSearch.lns_fails, 1u) : 0;
+    }
+
+    if(s->status(*this) == Gecode::SS_FAILED) {
+        fail++;
+        delete s;
+        if(_fixed == 0) {
+            //Nothing better than the incumbent, or no solution at all
+            engine().prove();
+        }
+        return;
+    }
+    cur = s;
+    idle = false;
+}
+
+/*
+ * Statistics
+ */
+Gecode::Search::Statistics
+EPS_LNS::statistics(void) const {
+    Gecode::Search::Statistics s;
+    for (unsigned int i=0; i<workers(); i++)
+        s += worker(i)->statistics();
+    return s;
+}
+
+/*
+ * Actual work
+ */
+void
+EPS_LNS::Worker::run(void) {
+    //Allocations of the worker come from its own arena (jemalloc only)
+    allocatorBindThread();
+    // Okay, we are in business, start working
+    while (true) {
+        switch (engine().cmd()) {
+        case C_WAIT:
+            // Wait
+            engine().wait();
+            break;
+        case C_TERMINATE:
+            // Acknowledge termination request
+            engine().ack_terminate();
+            // Wait until termination can proceed
+            engine().wait_terminate();
+            // Terminate thread
+            engine().terminated();
+            return;
+        case C_RESET:
+            // Acknowledge reset request
+            engine().ack_reset_start();
+            // Wait until reset has been performed
+            engine().wait_reset();
+            // Acknowledge that reset cycle is over
+            engine().ack_reset_stop();
+            break;
+        case C_WORK:
+            // Perform exploration work
+        {
+            if(!done) {
+                if(engine()._proven) {
+                    //The incumbent is optimal, or there is no solution
+                    delete cur;
+                    cur = NULL;
+                    path.reset(0);
+                    done = true;
+                    engine().idle();
+                } else if (idle) {
+                    relax();
+                } else if (cur != NULL) {
+                    start();
+                    if (stop(engine().opt())) {
+                        // Report stop
+                        engine().stop();
+                    } else if (_limit > 0 && fail >= _limit) {
+                        //Neighbourhood abandoned, the next one is relaxed around the incumbent
+                        idle = true;
+                    } else {
+                        node++;
+                        switch (cur->status(*this)) {
+                        case Gecode::SS_FAILED:
+                            fail++;
+                            delete cur;
+                            cur = NULL;
+                            break;
+                        case Gecode::SS_SOLVED: {
+                            // Deletes all pending branchers
+                            (void) cur->choice();
+                            //Better than the incumbent of the neighbourhood, the next one is relaxed around it
+                            engine().solution(this, cur);
+                            cur = NULL;
+                            idle = true;
+                        }
+                        break;
+                        case Gecode::SS_BRANCH: {
+                            Gecode::Space* c;
+                            if ((d == 0) || (d >= engine().opt().c_d)) {
+                                c = cur->clone();
+                                d = 1;
+                            } else {
+                                c = NULL;
+                                d++;
+                            }
+                            const Gecode::Choice* ch = path.push(*this,cur,c);
+                            cur->commit(*ch,0);
+                        }
+                        break;
+                        default:
+                            GECODE_NEVER;
+                        }
+                    }
+                } else if (path.next()) {
+                    cur = path.recompute(d, engine().opt().a_d,*this);
+                } else {
+                    //Neighbourhood exhausted within its limit
+                    if(_fixed == 0) {
+                        //Nothing was fixed, the whole search space is exhausted
+                        engine().prove();
+                    }
+                    idle = true;
+                }
+            }
+        }
+        break;
+        default:
+            GECODE_NEVER;
+        }
+    }
+}
+
+/*
+ * Termination and deletion
+ */
+EPS_LNS::Worker::~Worker(void) {
+    delete best;
+    delete _space_root;
+}
+
+EPS_LNS::~EPS_LNS(void) {
+    //The threads delete their workers
+    terminate();
+    Gecode::heap.rfree(_workers);
+    delete best;
+}
+
+/*
+   * Create no-goods
+   *
+   */
+Gecode::NoGoods&
+EPS_LNS::nogoods(void) {
+    Gecode::NoGoods* ng;
+    // Grab wait lock for reset
+    m_wait_reset.acquire();
+    // Release workers for reset
+    release(C_RESET);
+    // Wait for reset cycle started
+    e_reset_ack_start.wait();
+    ng = &worker(0)->nogoods();
+    // Block workers again to ensure invariant
+    block();
+    // Release reset lock
+    m_wait_reset.release();
+    // Wait for reset cycle stopped
+    e_reset_ack_stop.wait();
+    return *ng;
+}
+
+}
+
+
+//Function to return the EPS_LNS object
+Gecode::Search::Engine*
+eps_lns_to_engine(Gecode::Space* s, const MySearchOptions& o) {
+    MySearchOptions to = o.expand();
+    to.a_d = o.a_d;
+    to.c_d = o.c_d;
+    to.clone = o.clone;
+    to.stop = o.stop;
+    to.lns_relax = o.lns_relax;
+    to.lns_fails = o.lns_fails;
+    to.lns_neighbourhood = o.lns_neighbourhood;
+    to.seed = o.seed;
+
+    return new Parallel::EPS_LNS(s,to);
+}
@@ -7,9 +7,13 @@
 
 #include "search.h"
 #include "stl_util.h"
+#include "allocator.h"
+#include "memory.h"
+#include "trajectory.h"
 
 #include <vector>
 #include <string>
+#include <sstream>
 using namespace std;
 using namespace Gecode;
 using namespace FlatZinc;
@@ -544,6 +548,9 @@ void MyFlatZincSpace::run(std::ostream& out, const std::string& name_instance, c
                 || opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_GENERATION) {
             //BAB EPS
             runEngine<EPS_BAB>(out,name_instance,p,opt,t_total);
+        } else if (opt.search() == MyFlatZincOptions::FZ_SEARCH_LNS) {
+            //Parallel LNS
+            runEngine<EPS_LNS>(out,name_instance,p,opt,t_total);
         } else {
             //BAB
             runEngine<BAB>(out,name_instance,p,opt,t_total);
@@ -625,6 +632,35 @@ MyFlatZincSpace::runMeta(std::ostream& out, const std::string& name_instance, co
     o.threads = opt.threads();
     o.threads = o.expand().threads;
     o.cutoff = Gecode::Driver::createCutoff(opt);
+    //Each eps worker follows its own restart sequence, a cutoff is not shared between threads
+    o.restart = opt.restart();
+    o.restart_scale = opt.restart_scale();
+    o.restart_base = opt.restart_base();
+    //Nogoods of the abandoned path posted at each restart of a worker
+    o.nogoods_limit = opt.nogoods() ? opt.nogoods_limit() : 0;
+    o.lns_relax = opt.lns_relax();
+    o.lns_fails = opt.lns_fails();
+    o.lns_neighbourhood = opt.lns_neighbourhood();
+    o.seed = opt.seed();
+
+    //Branchings raced by the groups of workers, named as for -branching
+    std::vector<std::string> portfolio;
+    if(opt.portfolio()) {
+        std::stringstream ss(opt.portfolio());
+        std::string name;
+        while(std::getline(ss, name, ',')) {
+            if(name.empty()) {
+                continue;
+            }
+            int branching = opt.branchingValue(name.c_str());
+            if(branching < 0) {
+                std::cerr << "Warning: branching variant " << name << " unknown to the model, ignored by the portfolio" << std::endl;
+                continue;
+            }
+            portfolio.push_back(name);
+            o.portfolio.push_back(branching);
+        }
+    }
 
     o.mode_search = opt.search();
     o.first_level = opt.firstLevel();
@@ -632,15 +668,123 @@ MyFlatZincSpace::runMeta(std::ostream& out, const std::string& name_instance, co
     if(opt.obj_file()) {
         o.obj_file = opt.obj_file();
     }
+
+    o.progress_interval = opt.progress();
+    if(opt.progress_file()) {
+        o.progress_file = opt.progress_file();
+    }
+    o.order = opt.order();
+    o.probe_nodes = opt.probe_nodes();
+    o.affinity = opt.affinity();
+    o.chunk_size = opt.chunk_size();
+    o.chunk = opt.chunk();
+    o.chunk_time = opt.chunk_time();
+    o.memory_budget = static_cast<size_t>(opt.memory_budget()) * 1024 * 1024;
+    o.stream_batch = opt.stream_batch();
+    //Counting enumerates every solution (satisfaction only)
+    o.count_only = opt.count_only() && _method == SAT;
+    o.solution_limit = _method == SAT && !o.count_only ? opt.solutions() : 0;
+
+    //Reproducible eps: the subproblems are generated sequentially and committed
+    //in generation order, so the decomposition, the order and the printing are fixed
+    o.deterministic = opt.deterministic() && opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS;
+    if(o.deterministic) {
+        if(o.mode_decomposition != MyFlatZincOptions::ModeDecomposition::SIMPLE) {
+            o.mode_decomposition = MyFlatZincOptions::ModeDecomposition::DBDFS;
+        }
+        o.order = MyFlatZincOptions::ORDER_FIFO;
+        o.portfolio.clear();
+        portfolio.clear();
+    }
+
+    //All the solutions are printed by a writer thread or by the eps workers (satisfaction only)
+    bool printAll = opt.allSolutions() && !o.count_only;
+    ShardOutput shards;
+    shards.out = &out;
+    shards.printer = &p;
+    if(printAll && opt.print_solutions() == MyFlatZincOptions::PRINT_SHARDS &&
+       opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS && _method == SAT && o.solution_limit == 0 && !o.deterministic) {
+        o.shards = &shards;
+    }
+    SolutionWriter* writer = NULL;
+    if(printAll && !o.shards && opt.print_solutions() != MyFlatZincOptions::PRINT_DIRECT) {
+        writer = new SolutionWriter(out, p);
+    }
     _time_subproblems_workers = new std::vector< std::vector<unsigned int> >();
+    _memory_workers = new std::vector<size_t>();
+    _portfolio_wins = new std::vector<unsigned int>(portfolio.size(), 0);
+    _lock_statistics = new EngineLockStatistics();
+    _trace_subproblems_workers = new std::vector< std::vector<SubProblemTrace> >();
+
+    //Time boxed search of an incumbent, its bound prunes the decomposition and the subproblems.
+    //The bound is not strict, the eps search finds the incumbent again. The incumbent is
+    //kept as the first solution, the eps search may stop before finding it again
+    int warm_objective = -1;
+    unsigned int time_warm_start = 0;
+    unsigned int time_warm_found = 0;
+    MyFlatZincSpace* warm = NULL;
+    if(opt.warm_start() > 0 && _method != SAT && _space_hook && status() != SS_FAILED) {
+        Support::Timer t_warm;
+        t_warm.start();
+        MySearchOptions ow(o);
+        ow.stop = Driver::CombinedStop::create(0, 0, opt.warm_start(), false);
+        if(opt.warm_start_search() == MyFlatZincOptions::WARM_START_LNS) {
+            EPS_LNS<MyFlatZincSpace> ws(this, ow);
+            while (MyFlatZincSpace* s = ws.next()) {
+                delete warm;
+                warm = s;
+                time_warm_found = static_cast<unsigned int>(floor(t_total.stop()));
+            }
+        } else {
+            ow.threads = 1;
+            BAB<MyFlatZincSpace> ws(this, ow);
+            while (MyFlatZincSpace* s = ws.next()) {
+                delete warm;
+                warm = s;
+                time_warm_found = static_cast<unsigned int>(floor(t_total.stop()));
+            }
+        }
+        delete ow.stop;
+        time_warm_start = static_cast<unsigned int>(floor(t_warm.stop()));
+
+        if(warm) {
+            if(_method == MIN) {
+                warm_objective = warm->iv[warm->_optVar].max();
+                rel(*this, iv[_optVar], IRT_LQ, warm_objective);
+                rel(*_space_hook, _space_hook->iv[_space_hook->_optVar], IRT_LQ, warm_objective);
+            } else {
+                warm_objective = warm->iv[warm->_optVar].min();
+                rel(*this, iv[_optVar], IRT_GQ, warm_objective);
+                rel(*_space_hook, _space_hook->iv[_space_hook->_optVar], IRT_GQ, warm_objective);
+            }
+            //The engines clone both spaces, they must be stable again. The incumbent meets its
+            //own bound, a failure is not expected: the eps search then only reports the incumbent
+            if(status() == SS_FAILED || _space_hook->status() == SS_FAILED) {
+                fail();
+                _space_hook->fail();
+            }
+        }
+    }
+
+    //Unbounded, the probes of an optimization rank first the subproblems that the first
+    //incumbent prunes (inverted ranking): lpt needs the bound of a warm start
+    if(o.order == MyFlatZincOptions::ORDER_LPT && _method != SAT && !warm) {
+        std::cerr << "Warning: -order lpt needs an incumbent for an optimization (see -warm_start), fifo used" << std::endl;
+        o.order = MyFlatZincOptions::ORDER_FIFO;
+    }
+
+    //The workers date their solutions when they find them, not when they are reported
+    _timer_run = &t_total;
+    if(_space_hook) {
+        _space_hook->_timer_run = &t_total;
+    }
 
     if (opt.interrupt())
         Driver::CombinedStop::installCtrlHandler(true);
     //Meta<Engine, MyFlatZincSpace> se(this, o); //Meta Problem with SearchOption !!!
     Engine<MyFlatZincSpace> se(this, o); //Meta Problem with SearchOption !!!
 
-    int noOfSolutions = _method == SAT ? opt.solutions() : 0;
-    bool printAll = opt.allSolutions();
+    int noOfSolutions = _method == SAT && !o.count_only ? opt.solutions() : 0;
     int findSol = noOfSolutions;
     MyFlatZincSpace* sol = NULL;
 
@@ -648,6 +792,21 @@ MyFlatZincSpace::runMeta(std::ostream& out, const std::string& name_instance, co
     int nbsolutions = 0;
     unsigned int time_first_solution = 0;
     unsigned int time_last_solution = 0;
+    //Improvements of the objective over time
+    std::vector<TrajectoryPoint> trajectory;
+
+    if(warm) {
+        //Printed as the first solution, and as the last one if the eps search finds no better
+        sol = warm;
+        objective = warm_objective;
+        nbsolutions = 1;
+        time_first_solution = time_last_solution = time_warm_found;
+        trajectory.push_back(TrajectoryPoint(time_last_solution, objective, -1, -1));
+        if (printAll && !writer) {
+            sol->print(out, p);
+            out << "----------" << std::endl;
+        }
+    }
 
     while (MyFlatZincSpace* next_sol = se.next()) {
 
@@ -657,9 +816,13 @@ MyFlatZincSpace::runMeta(std::ostream& out, const std::string& name_instance, co
             time_first_solution = time_last_solution;
         }
 
-        delete sol;
+        if(writer && sol) {
+            writer->push(sol);
+        } else {
+            delete sol;
+        }
         sol = next_sol;
-        if (printAll) {
+        if (printAll && !writer) {
             sol->print(out, p);
             out << "----------" << std::endl;
         }
@@ -669,28 +832,60 @@ MyFlatZincSpace::runMeta(std::ostream& out, const std::string& name_instance, co
             } else {
                 objective = sol->iv[sol->_optVar].min();
             }
+            //Dated when found if the engine stamped it, the points stay in report order
+            unsigned int time_found = sol->_solution_time >= 0 ?
+                                      std::min(time_last_solution, static_cast<unsigned int>(floor(sol->_solution_time))) : time_last_solution;
+            if(!trajectory.empty()) {
+                time_found = std::max(time_found, trajectory.back().time);
+            }
+            //The incumbent of the warm start found again is no improvement
+            if(trajectory.empty() || trajectory.back().objective != objective) {
+                trajectory.push_back(TrajectoryPoint(time_found, objective, sol->_solution_worker, sol->_solution_subproblem));
+            }
         }
 
         if (--findSol==0) {
-            delete sol;
+            if(writer) {
+                writer->push(sol);
+            } else {
+                delete sol;
+            }
             goto stopped;
         }
     }
+    if(writer) {
+        //The writer prints the last solution, sol only tells whether there was one
+        if(sol) {
+            writer->push(sol);
+        }
+        writer->finish();
+        sol = NULL;
+    }
+    if(o.count_only || o.shards) {
+        //Solutions counted (and printed in shards) by the eps workers, never reported
+        nbsolutions += _count_solutions;
+        delete sol;
+        sol = NULL;
+        if(o.count_only) {
+            out << "%% " << nbsolutions << " solutions" << std::endl;
+        }
+    }
     if (sol && !printAll) {
         sol->print(out, p);
         out << "----------" << std::endl;
     }
     if (!se.stopped()) {
-        if (sol) {
+        if (sol || nbsolutions) {
             out << "==========" << endl;
         } else {
             out << "=====UNSATISFIABLE=====" << endl;
         }
-    } else if (!sol) {
+    } else if (!sol && !nbsolutions) {
         out << "=====UNKNOWN=====" << endl;
     }
     delete sol;
 stopped:
+    delete writer;
 
     if (opt.interrupt())
         Driver::CombinedStop::installCtrlHandler(false);
@@ -710,10 +905,14 @@ stopped:
     }
 
     string mode_decomposition("simple");
-    if(opt.mode_decomposition() == MyFlatZincOptions::ModeDecomposition::DBDFS) {
+    if(o.mode_decomposition == MyFlatZincOptions::ModeDecomposition::DBDFS) {
         mode_decomposition = "dbdfs";
-    } else if(opt.mode_decomposition() == MyFlatZincOptions::ModeDecomposition::DBDFSwP) {
+    } else if(o.mode_decomposition == MyFlatZincOptions::ModeDecomposition::DBDFSwP) {
         mode_decomposition = "dbdfswP";
+    } else if(o.mode_decomposition == MyFlatZincOptions::ModeDecomposition::RDBDFSwP) {
+        mode_decomposition = "rdbdfswP";
+    } else if(o.mode_decomposition == MyFlatZincOptions::ModeDecomposition::SDBDFS) {
+        mode_decomposition = "sdbdfs";
     }
 
     string type_search("bab");
@@ -721,6 +920,8 @@ stopped:
         type_search = "eps";
     } else if(_method == SAT) {
         type_search = "dfs";
+    } else if (opt.search() == MyFlatZincOptions::FZ_SEARCH_LNS) {
+        type_search = "lns";
     } else if (opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_GENERATION) {
         type_search = "eps_grid_generation";
     } else if (opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_COMPUTATION) {
@@ -805,6 +1006,9 @@ stopped:
             << status << endl
             << "%%  initial_objective:     "
             << initial_objective << endl
+            << string(opt.warm_start() > 0 ? "%%  warm start:     objective "
+                      + stl_util::Convert2String(warm_objective) + ", "
+                      + stl_util::Convert2String(time_warm_start) + " ms\n" : "")
             << "%%  objective:     "
             << objective << endl
             << "%%  decision variables:     "
@@ -815,9 +1019,11 @@ stopped:
             << "%%  propagations:  " << sstat.propagate+stat.propagate << endl
             << "%%  nodes:         " << stat.node << endl
             << "%%  failures:      " << stat.fail << endl
+            << "%%  restarts:      " << stat.restart << endl
+            << "%%  nogoods:       " << stat.nogood << endl
             << "%%  peak depth:    " << stat.depth << endl
-            //<< "%%  peak memory:   "
-            //<< static_cast<int>((stat.memory+1023) / 1024) << " KB\n"
+            << "%%  peak memory:   "
+            << (peakResidentMemory() + 1023) / 1024 << " KB (resident)" << endl
             << "%%  depth decomposition:     "
             << this->_depth_decomposition << endl
             << "%%  iterations decomposition:     "
@@ -826,12 +1032,21 @@ stopped:
             << opt.problems() << endl
             << "%%  generated problems decomposition:     "
             << this->_problems << endl
+            << "%%  generation rate decomposition:     "
+            << (this->_time_decomposition ? this->_problems * 1000.0 / this->_time_decomposition : 0.0) << " problems/s" << endl
             << "%%  time max inactivity worker:     "
             << this->_time_max_inactivity / 1000.0 << " (" << this->_time_max_inactivity << " ms)" << endl
+            << string(this->_time_limit_stop >= 0 ? "%%  time stop solution limit:     workers "
+                      + stl_util::Convert2String(this->_time_limit_stop) + " ms, runtime "
+                      + stl_util::Convert2String(time_total - time_last_solution) + " ms after the last solution\n" : "")
             << "%%  nodes decomposition:         " << this->_nodes_decomposition << endl
             << "%%  failures decomposition:      " << this->_fails_decomposition << endl
-            //<< "%%  peak memory decomposition:   "
-            //<< static_cast<int>((this->_memory_decomposition+1023) / 1024) << " KB\n"
+            << "%%  peak memory decomposition:   "
+            << (this->_memory_decomposition + 1023) / 1024 << " KB" << endl
+            << "%%  memory problems:     "
+            << (this->_memory_subproblems + 1023) / 1024 << " KB" << endl
+            << "%%  memory budget decomposition:     "
+            << opt.memory_budget() << " MB (reached " << this->_memory_limited << " times)" << endl
             << "%%  sum time problems:     "
             << sum_timesubproblems / 1000.0 << " (" << sum_timesubproblems << " ms)" << endl
             << "%%  min time problems:     "
@@ -839,20 +1054,170 @@ stopped:
             << "%%  max time problems:     "
             << max_timesubproblems / 1000.0 << " (" << max_timesubproblems << " ms)" << endl
             << "%%  time problems:     "
-            << timesubproblems << endl;
+            << timesubproblems << endl
+            << string(o.deterministic ? "%%  deterministic:     wait "
+                      + stl_util::Convert2String(static_cast<unsigned int>(floor(this->_time_deterministic_wait))) + " ms, peak held "
+                      + stl_util::Convert2String(this->_deterministic_held) + "\n" : "");
+
+        if (opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS
+                || opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_GENERATION) {
+            const EngineLockStatistics& ls = *_lock_statistics;
+            out << "%%  lock findjob resolution:     "
+                << ls.findjob_resolution.acquisitions << " acquisitions, "
+                << ls.findjob_resolution.wait.count << " contended, wait "
+                << ls.findjob_resolution.wait.total << " ms (max " << ls.findjob_resolution.wait.max << " ms)" << endl
+                << "%%  lock findjob decomposition:     "
+                << ls.findjob_decomposition.acquisitions << " acquisitions, "
+                << ls.findjob_decomposition.wait.count << " contended, wait "
+                << ls.findjob_decomposition.wait.total << " ms (max " << ls.findjob_decomposition.wait.max << " ms)" << endl
+                << "%%  lock search:     "
+                << ls.search.acquisitions << " acquisitions, "
+                << ls.search.wait.count << " contended, wait "
+                << ls.search.wait.total << " ms (max " << ls.search.wait.max << " ms)" << endl
+                << "%%  dispatch problems:     "
+                << ls.dispatch.count << " dispatches, total "
+                << ls.dispatch.total << " ms (avg " << ls.dispatch.average() << " ms, max " << ls.dispatch.max << " ms)" << endl;
+        }
+
+        if(_memory_workers && _memory_workers->size()) {
+            //Measured through the jemalloc counters of the threads, estimated from the spaces held otherwise
+            const uint64_t* allocated;
+            const uint64_t* deallocated;
+            bool measured = allocatorThreadCounters(allocated, deallocated);
+            string memoryworkers;
+            for(size_t i = 0; i < _memory_workers->size(); i++) {
+                memoryworkers += stl_util::Convert2String(((*_memory_workers)[i] + 1023) / 1024) + " ";
+            }
+            out << "%%  memory space:     "
+                << (this->_memory_space + 1023) / 1024 << " KB" << endl
+                << "%%  peak memory workers:     "
+                << (*std::max_element(_memory_workers->begin(), _memory_workers->end()) + 1023) / 1024 << " KB max ("
+                << (measured ? "measured" : "estimated") << ")" << endl
+                << "%%  memory workers:     "
+                << memoryworkers << endl;
+        }
+
+        if(_portfolio_wins && _portfolio_wins->size()) {
+            //Subproblems won by each branching of the portfolio
+            string wins;
+            for(size_t i = 0; i < portfolio.size(); i++) {
+                wins += portfolio[i] + ":" + stl_util::Convert2String((*_portfolio_wins)[i]) + " ";
+            }
+            out << "%%  portfolio wins (branching:problems):     "
+                << wins << endl;
+        }
+
+        if(_method != SAT) {
+            //Anytime quality against the best objective of the run
+            out << "%%  objective trajectory (ms:objective:worker:subproblem):     "
+                << trajectoryString(trajectory) << endl
+                << "%%  primal integral:     "
+                << (nbsolutions > 0 ? primalIntegral(trajectory, objective, time_total) : time_total / 1000.0)
+                << " (horizon " << time_total << " ms)" << endl;
+        }
+
+        if(opt.search() == MyFlatZincOptions::FZ_SEARCH_LNS && _method != SAT) {
+            out << "%%  lns neighbourhoods:     "
+                << this->_lns_neighbourhoods << " (" << this->_lns_improvements << " improving)" << endl;
+        }
+
+        AllocatorStatistics as = allocatorStatistics();
+        out << "%%  allocator:     "
+            << as.name << " (" << as.arenas << " arenas)" << endl
+            << "%%  allocator memory:     allocated "
+            << (as.allocated + 1023) / 1024 << " KB, active "
+            << (as.active + 1023) / 1024 << " KB, resident "
+            << (as.resident + 1023) / 1024 << " KB, mapped "
+            << (as.mapped + 1023) / 1024 << " KB" << endl;
+
+        if(o.order == MyFlatZincOptions::ORDER_LPT && _trace_subproblems_workers) {
+            //Rank correlation between the estimated hardness and the time of the subproblems
+            std::vector<double> estimated;
+            std::vector<double> measured;
+            string traceproblems;
+            for(size_t i = 0; i < _trace_subproblems_workers->size(); i++) {
+                for(size_t j = 0; j < (*_trace_subproblems_workers)[i].size(); j++) {
+                    const SubProblemTrace& t = (*_trace_subproblems_workers)[i][j];
+                    estimated.push_back(t.hardness);
+                    measured.push_back(t.time);
+                    traceproblems += stl_util::Convert2String(t.id) + ":" + stl_util::Convert2String(i) + ":"
+                                     + stl_util::Convert2String(t.hardness) + ":" + stl_util::Convert2String(t.time / 1000.0) + " ";
+                }
+            }
+            out << "%%  hardness rank correlation:     "
+                << rankCorrelation(estimated, measured) << endl
+                << "%%  trace problems (id:worker:hardness:time):     "
+                << traceproblems << endl;
+        }
     }
 
     delete _time_subproblems_workers;
     _time_subproblems_workers = NULL;
 
+    delete _memory_workers;
+    _memory_workers = NULL;
+
+    delete _portfolio_wins;
+    _portfolio_wins = NULL;
+
+    delete _lock_statistics;
+    _lock_statistics = NULL;
+
+    delete _trace_subproblems_workers;
+    _trace_subproblems_workers = NULL;
+
     delete this->_name_instance;
     this->_name_instance = NULL;
 }
 
-void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed, double decay,
+/// Whether the selection \a s of an int or bool branching ranks the variables by afc
+static bool afcVarSel(const IntVarBranch& s) {
+    switch(s.select()) {
+    case IntVarBranch::SEL_AFC_MIN: case IntVarBranch::SEL_AFC_MAX:
+    case IntVarBranch::SEL_AFC_SIZE_MIN: case IntVarBranch::SEL_AFC_SIZE_MAX:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool afcVarSel(const TieBreak<IntVarBranch>& s) {
+    return afcVarSel(s.a) || afcVarSel(s.b) || afcVarSel(s.c) || afcVarSel(s.d);
+}
+
+#ifdef GECODE_HAS_SET_VARS
+static bool afcVarSel(const SetVarBranch& s) {
+    switch(s.select()) {
+    case SetVarBranch::SEL_AFC_MIN: case SetVarBranch::SEL_AFC_MAX:
+    case SetVarBranch::SEL_AFC_SIZE_MIN: case SetVarBranch::SEL_AFC_SIZE_MAX:
+        return true;
+    default:
+        return false;
+    }
+}
+#endif
+
+#ifdef GECODE_HAS_FLOAT_VARS
+static bool afcVarSel(const FloatVarBranch& s) {
+    switch(s.select()) {
+    case FloatVarBranch::SEL_AFC_MIN: case FloatVarBranch::SEL_AFC_MAX:
+    case FloatVarBranch::SEL_AFC_SIZE_MIN: case FloatVarBranch::SEL_AFC_SIZE_MAX:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool afcVarSel(const TieBreak<FloatVarBranch>& s) {
+    return afcVarSel(s.a) || afcVarSel(s.b) || afcVarSel(s.c) || afcVarSel(s.d);
+}
+#endif
+
+bool MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed, double decay,
                                       bool ignoreUnknown,
                                       std::ostream& err) {
     //std::cerr << "createBranchers\n";
+    bool afc = false;
     //if(_space_hook) {
     //    delete _space_hook;
     //}
@@ -923,8 +1288,10 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
                     names.push_back(vars->a[i]->getVarName());
                 }
                 std::string r0, r1;
+                TieBreak<IntVarBranch> varsel = ann2ivarsel(args->a[1],rnd,decay);
+                afc = afc || afcVarSel(varsel);
                 BrancherHandle bh = branch(*this, va,
-                                           ann2ivarsel(args->a[1],rnd,decay),
+                                           varsel,
                                            ann2ivalsel(args->a[2],r0,r1,rnd),
                                            NULL,
                                            &varValPrint<IntVar>);
@@ -967,8 +1334,10 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
                 }
 
                 std::string r0, r1;
+                TieBreak<IntVarBranch> varsel = ann2ivarsel(args->a[1],rnd,decay);
+                afc = afc || afcVarSel(varsel);
                 BrancherHandle bh = branch(*this, va,
-                                           ann2ivarsel(args->a[1],rnd,decay),
+                                           varsel,
                                            ann2ivalsel(args->a[2],r0,r1,rnd), NULL,
                                            &varValPrint<BoolVar>);
                 branchInfo.add(bh,r0,r1,names);
@@ -1004,8 +1373,10 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
                     names.push_back(vars->a[i]->getVarName());
                 }
                 std::string r0, r1;
+                SetVarBranch varsel = ann2svarsel(args->a[1],rnd,decay);
+                afc = afc || afcVarSel(varsel);
                 BrancherHandle bh = branch(*this, va,
-                                           ann2svarsel(args->a[1],rnd,decay),
+                                           varsel,
                                            ann2svalsel(args->a[2],r0,r1,rnd),
                                            NULL,
                                            &varValPrint<SetVar>);
@@ -1065,8 +1436,10 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
                     names.push_back(vars->a[i]->getVarName());
                 }
                 std::string r0, r1;
+                TieBreak<FloatVarBranch> varsel = ann2fvarsel(args->a[2],rnd,decay);
+                afc = afc || afcVarSel(varsel);
                 BrancherHandle bh = branch(*this, va,
-                                           ann2fvarsel(args->a[2],rnd,decay),
+                                           varsel,
                                            ann2fvalsel(args->a[3],r0,r1),
                                            NULL,
                                            &varValPrintF);
@@ -1143,10 +1516,14 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
         }
     }
 
-    if (iv_sol.size() > 0)
+    if (iv_sol.size() > 0) {
         branch(*this, iv_sol, def_int_varsel, def_int_valsel);
-    if (bv_sol.size() > 0)
+        afc = afc || afcVarSel(def_int_varsel);
+    }
+    if (bv_sol.size() > 0) {
         branch(*this, bv_sol, def_bool_varsel, def_bool_valsel);
+        afc = afc || afcVarSel(def_bool_varsel);
+    }
 #ifdef GECODE_HAS_FLOAT_VARS
     introduced = 0;
     funcdep = 0;
@@ -1176,8 +1553,10 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
         }
     }
 
-    if (fv_sol.size() > 0)
+    if (fv_sol.size() > 0) {
         branch(*this, fv_sol, def_float_varsel, def_float_valsel);
+        afc = afc || afcVarSel(def_float_varsel);
+    }
 #endif
 #ifdef GECODE_HAS_SET_VARS
     introduced = 0;
@@ -1208,8 +1587,10 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
         }
     }
 
-    if (sv_sol.size() > 0)
+    if (sv_sol.size() > 0) {
         branch(*this, sv_sol, def_set_varsel, def_set_valsel);
+        afc = afc || afcVarSel(def_set_varsel);
+    }
 #endif
     iv_aux = IntVarArray(*this, iv_tmp);
     bv_aux = BoolVarArray(*this, bv_tmp);
@@ -1223,6 +1604,13 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
     n_aux =+ fv_aux.size();
 #endif
     if (n_aux > 0) {
+        afc = afc || afcVarSel(def_int_varsel) || afcVarSel(def_bool_varsel);
+#ifdef GECODE_HAS_SET_VARS
+        afc = afc || afcVarSel(def_set_varsel);
+#endif
+#ifdef GECODE_HAS_FLOAT_VARS
+        afc = afc || afcVarSel(def_float_varsel);
+#endif
         AuxVarBrancher::post(*this, def_int_varsel, def_int_valsel,
                              def_bool_varsel, def_bool_valsel
 #ifdef GECODE_HAS_SET_VARS
@@ -1233,6 +1621,7 @@ void MyFlatZincSpace::createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed
 #endif
                             );
     }
+    return afc;
 }
 
 Gecode::Space* MyFlatZincSpace::copy(bool share) {
@@ -1249,8 +1638,25 @@ MyFlatZincSpace::MyFlatZincSpace(bool share, MyFlatZincSpace& f)
       _nodes_decomposition(f._nodes_decomposition),
       _fails_decomposition(f._fails_decomposition),
       _memory_decomposition(f._memory_decomposition),
+      _memory_subproblems(f._memory_subproblems),
+      _memory_space(f._memory_space),
+      _memory_limited(f._memory_limited),
       _time_max_inactivity(f._time_max_inactivity),
+      _time_limit_stop(f._time_limit_stop),
+      _count_solutions(f._count_solutions),
+      _lns_neighbourhoods(f._lns_neighbourhoods),
+      _lns_improvements(f._lns_improvements),
+      _solution_worker(f._solution_worker),
+      _solution_subproblem(f._solution_subproblem),
+      _solution_time(f._solution_time),
+      _timer_run(f._timer_run),
+      _time_deterministic_wait(f._time_deterministic_wait),
+      _deterministic_held(f._deterministic_held),
       _time_subproblems_workers(NULL),
+      _memory_workers(NULL),
+      _lock_statistics(NULL),
+      _trace_subproblems_workers(NULL),
+      _portfolio_wins(NULL),
       _name_instance(f._name_instance)
 
   /*,
@@ -1339,6 +1745,12 @@ struct ArrayVarIndexCompare {
     }
 };
 
+void MyFlatZincSpace::stampSolution(int worker, int subproblem) {
+    _solution_worker = worker;
+    _solution_subproblem = subproblem;
+    _solution_time = _timer_run ? _timer_run->stop() : -1.0;
+}
+
 void MyFlatZincSpace::sortVariables(bool less) {
 
     /*
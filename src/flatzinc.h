@@ -41,6 +41,10 @@
 
 #include <gecode/flatzinc.hh>
 #include <string>
+#include <vector>
+
+#include "lock_statistics.h"
+#include "subproblem.h"
 
 
 class MyFlatZincOptions : public Gecode::FlatZinc::FlatZincOptions {
@@ -54,6 +58,7 @@ protected:
     Gecode::Driver::StringOption _propagation; ///< Propagation options
     Gecode::Driver::StringOption _icl;         ///< Integer consistency level
     Gecode::Driver::StringOption _branching;   ///< Branching options
+    std::vector< std::pair<std::string, int> > _branching_variants; ///< Named branchings of the model
 
 
     /// \name Search options
@@ -80,6 +85,27 @@ protected:
 
     Gecode::Driver::StringValueOption     _dl; ///< like SizeOption
 
+    Gecode::Driver::UnsignedIntOption _progress; ///< Interval of progress reports for eps
+    Gecode::Driver::StringValueOption _progress_file; ///< Progress report file path
+    Gecode::Driver::StringOption _order; ///< Dispatch order of the subproblems
+    Gecode::Driver::UnsignedIntOption _probe_nodes; ///< Node limit of the hardness probe
+    Gecode::Driver::StringOption _affinity; ///< Placement of the workers on the cpus
+    Gecode::Driver::UnsignedIntOption _chunk_size; ///< Subproblems handed to a worker at once
+    Gecode::Driver::StringOption _chunk; ///< Chunking of the subproblem dispatch
+    Gecode::Driver::UnsignedIntOption _chunk_time; ///< Targeted duration of an adaptive chunk
+    Gecode::Driver::UnsignedIntOption _memory_budget; ///< Memory budget of the decomposition
+    Gecode::Driver::UnsignedIntOption _stream_batch; ///< Subproblems generated at once by the streamed decomposition
+    Gecode::Driver::BoolOption _count_only; ///< Only count the solutions
+    Gecode::Driver::StringOption _print_solutions; ///< Printing of the solutions
+    Gecode::Driver::StringValueOption _portfolio; ///< Branchings of the eps portfolio
+    Gecode::Driver::UnsignedIntOption _lns_relax; ///< Relaxed variables of an lns neighbourhood
+    Gecode::Driver::UnsignedIntOption _lns_fails; ///< Failure limit of an lns neighbourhood
+    Gecode::Driver::StringOption _lns_neighbourhood; ///< Choice of the relaxed variables
+    Gecode::Driver::UnsignedIntOption _warm_start; ///< Time box of the warm start
+    Gecode::Driver::StringOption _warm_start_search; ///< Search of the warm start
+    Gecode::Driver::BoolOption _deterministic; ///< Deterministic eps
+    Gecode::Driver::BoolOption _afc_decomposition; ///< Afc of the decomposition
+
 public:
 
     enum ModelOptions {
@@ -104,14 +130,50 @@ public:
         FZ_SEARCH_BAB, //< Branch-and-bound search
         FZ_SEARCH_EPS, //< EPS search
         FZ_SEARCH_EPS_GRID_GENERATION, //< EPS search
-        FZ_SEARCH_EPS_GRID_COMPUTATION //< EPS search
+        FZ_SEARCH_EPS_GRID_COMPUTATION, //< EPS search
+        FZ_SEARCH_LNS //< Parallel large neighbourhood search around a shared incumbent
 
     };
 
     enum ModeDecomposition {
         SIMPLE = 0,    //< SIMPLE
         DBDFS = 1, //< DBDFS generation of ndi problems in sequential
-        DBDFSwP = 2 //< DBDFSwP generation of ndi problems in parallel
+        DBDFSwP = 2, //< DBDFSwP generation of ndi problems in parallel
+        RDBDFSwP = 3, //< recursive DBDFSwP, the workers expand a shared frontier from the root
+        SDBDFS = 4 //< streamed DBDFS, the subproblems are generated lazily and dispatched in batches
+    };
+
+    enum OrderProblems {
+        ORDER_FIFO, //< dispatch the subproblems in generation order
+        ORDER_LPT //< dispatch the subproblems estimated hardest first
+    };
+
+    enum AffinityOptions {
+        AFFINITY_NONE, //< workers are not pinned
+        AFFINITY_COMPACT, //< fill the cpus of a NUMA node before the next one
+        AFFINITY_SCATTER //< spread the workers round robin over the NUMA nodes
+    };
+
+    enum ChunkOptions {
+        CHUNK_STATIC, //< chunks of chunk_size subproblems
+        CHUNK_GUIDED, //< chunks shrinking with the subproblems left
+        CHUNK_ADAPTIVE //< chunks lasting about chunk_time from the measured subproblem durations
+    };
+
+    enum PrintOptions {
+        PRINT_DIRECT, //< the main thread prints each solution
+        PRINT_WRITER, //< a writer thread prints the solutions in large buffered writes
+        PRINT_SHARDS //< each eps worker prints its solutions, the outputs are concatenated at the end
+    };
+
+    enum LnsNeighbourhoods {
+        LNS_RANDOM, //< the relaxed variables are drawn at random
+        LNS_WINDOW //< the relaxed variables are a window of consecutive variables at a random position
+    };
+
+    enum WarmStartOptions {
+        WARM_START_BAB, //< sequential branch-and-bound with the branchings of the model
+        WARM_START_LNS //< parallel large neighbourhood search
     };
 
     MyFlatZincOptions(const char* s) : Gecode::FlatZinc::FlatZincOptions(s),
@@ -125,7 +187,7 @@ public:
         _search("-search","search engine variant", FZ_SEARCH_BAB),
 
         _problems("-problems","number of problems generated for eps", 50),
-        _mode_decomposition("-mode_decomposition","mode decomposition for eps (0 = SIMPLE_DECOMPOSITION, 1 = DBDFS, 2 = DBDFSwP)", 1),
+        _mode_decomposition("-mode_decomposition","mode decomposition for eps (0 = SIMPLE_DECOMPOSITION, 1 = DBDFS, 2 = DBDFSwP, 3 = RDBDFSwP, 4 = SDBDFS)", 1),
 
         _add_ub("-add_ub","add upperbound", false),
         _add_lb("-add_lb","add lowerbound", false),
@@ -141,7 +203,28 @@ public:
         _first_level("-firstlevel", "first level to stop", 0),
         _cobj("-cobj", "communicate the objective during the resolution", false),
 
-        _dl("-dl","set levels for decomposition", "") {
+        _dl("-dl","set levels for decomposition", ""),
+
+        _progress("-progress","interval in ms between progress reports of eps (0 = no report)", 0),
+        _progress_file("-progress_file","progress report file path (default stderr)"),
+        _order("-order","dispatch order of the eps subproblems", ORDER_FIFO),
+        _probe_nodes("-probe_nodes","node limit of the probe estimating the hardness of a subproblem (lpt order)", 100),
+        _affinity("-affinity","placement of the eps workers on the cpus (none, compact, scatter)", AFFINITY_NONE),
+        _chunk_size("-chunk_size","number of subproblems handed to an eps worker at once (minimum of the guided and adaptive chunks)", 1),
+        _chunk("-chunk","size of the subproblem chunks handed to the eps workers (static, guided, adaptive)", CHUNK_STATIC),
+        _chunk_time("-chunk_time","targeted duration of an adaptive chunk (ms)", 10),
+        _memory_budget("-memory_budget","memory budget of the decomposition, 0 for none (MB)", 0),
+        _stream_batch("-stream_batch","subproblems generated at once by the streamed decomposition", 1000),
+        _count_only("-count_only","only count the solutions, eps workers neither clone nor queue them", false),
+        _print_solutions("-print_solutions","printing of all the solutions (direct, writer thread, eps worker shards)", PRINT_DIRECT),
+        _portfolio("-portfolio","comma separated branching variants raced on the same subproblems by groups of eps workers"),
+        _lns_relax("-lns_relax","percentage of the integer variables relaxed by a neighbourhood of the lns search, one more after each neighbourhood without improvement", 30),
+        _lns_fails("-lns_fails","failures after which an lns neighbourhood is abandoned", 500),
+        _lns_neighbourhood("-lns_neighbourhood","variables relaxed by an lns neighbourhood (random, window)", LNS_RANDOM),
+        _warm_start("-warm_start","time box of the search of an incumbent before the eps decomposition, 0 for none (ms)", 0),
+        _warm_start_search("-warm_start_search","search of the incumbent before the eps decomposition (bab, lns)", WARM_START_BAB),
+        _deterministic("-deterministic","reproducible eps: sequential decomposition in fifo order, solutions and bounds committed in subproblem order", false),
+        _afc_decomposition("-afc_decomposition","record the failures of the eps decomposition in the afc of the branchings of the workers (no-op unless a branching selects by afc)", true) {
         //add suboptions
         _model.add(MODEL_FLATZINC, "flatzinc");
         _model.add(MODEL_NQUEENS, "nqueens");
@@ -168,6 +251,7 @@ public:
         _search.add(FZ_SEARCH_EPS, "eps");
         _search.add(FZ_SEARCH_EPS_GRID_GENERATION, "eps_grid_generation");
         _search.add(FZ_SEARCH_EPS_GRID_COMPUTATION, "eps_grid_computation");
+        _search.add(FZ_SEARCH_LNS, "lns");
 
         //add options
         add(_model);
@@ -195,6 +279,48 @@ public:
         add(_nspf);
 
         add(_dl);
+
+        add(_progress);
+        add(_progress_file);
+
+        _order.add(ORDER_FIFO, "fifo");
+        _order.add(ORDER_LPT, "lpt", "longest estimated subproblems first (optimization: only with -warm_start)");
+        add(_order);
+        add(_probe_nodes);
+
+        _affinity.add(AFFINITY_NONE, "none");
+        _affinity.add(AFFINITY_COMPACT, "compact");
+        _affinity.add(AFFINITY_SCATTER, "scatter");
+        add(_affinity);
+        add(_chunk_size);
+
+        _chunk.add(CHUNK_STATIC, "static");
+        _chunk.add(CHUNK_GUIDED, "guided");
+        _chunk.add(CHUNK_ADAPTIVE, "adaptive");
+        add(_chunk);
+        add(_chunk_time);
+        add(_memory_budget);
+        add(_stream_batch);
+        add(_count_only);
+
+        _print_solutions.add(PRINT_DIRECT, "direct");
+        _print_solutions.add(PRINT_WRITER, "writer");
+        _print_solutions.add(PRINT_SHARDS, "shards");
+        add(_print_solutions);
+        add(_portfolio);
+        add(_lns_relax);
+        add(_lns_fails);
+
+        _lns_neighbourhood.add(LNS_RANDOM, "random");
+        _lns_neighbourhood.add(LNS_WINDOW, "window");
+        add(_lns_neighbourhood);
+        add(_warm_start);
+
+        _warm_start_search.add(WARM_START_BAB, "bab");
+        _warm_start_search.add(WARM_START_LNS, "lns");
+        add(_warm_start_search);
+        add(_deterministic);
+        add(_afc_decomposition);
     }
 
     MyFlatZincOptions(const Gecode::FlatZinc::FlatZincOptions& o) : Gecode::FlatZinc::FlatZincOptions(o),
@@ -206,7 +332,7 @@ public:
 
         _search("-search","search engine variant", FZ_SEARCH_BAB),
         _problems("-problems","number of problems generated for eps", 50),
-        _mode_decomposition("-mode_decomposition","mode decomposition for eps (0 = SIMPLE_DECOMPOSITION, 1 = DBDFS, 2 = DBDFSwP)", 1),
+        _mode_decomposition("-mode_decomposition","mode decomposition for eps (0 = SIMPLE_DECOMPOSITION, 1 = DBDFS, 2 = DBDFSwP, 3 = RDBDFSwP, 4 = SDBDFS)", 1),
 
         _add_ub("-add_ub","add upperbound", false),
         _add_lb("-add_lb","add lowerbound", false),
@@ -225,7 +351,28 @@ public:
 
         _cobj("-cobj", "communicate the objective during the resolution", false),
 
-        _dl("-dl","set levels for decomposition", "") {
+        _dl("-dl","set levels for decomposition", ""),
+
+        _progress("-progress","interval in ms between progress reports of eps (0 = no report)", 0),
+        _progress_file("-progress_file","progress report file path (default stderr)"),
+        _order("-order","dispatch order of the eps subproblems", ORDER_FIFO),
+        _probe_nodes("-probe_nodes","node limit of the probe estimating the hardness of a subproblem (lpt order)", 100),
+        _affinity("-affinity","placement of the eps workers on the cpus (none, compact, scatter)", AFFINITY_NONE),
+        _chunk_size("-chunk_size","number of subproblems handed to an eps worker at once (minimum of the guided and adaptive chunks)", 1),
+        _chunk("-chunk","size of the subproblem chunks handed to the eps workers (static, guided, adaptive)", CHUNK_STATIC),
+        _chunk_time("-chunk_time","targeted duration of an adaptive chunk (ms)", 10),
+        _memory_budget("-memory_budget","memory budget of the decomposition, 0 for none (MB)", 0),
+        _stream_batch("-stream_batch","subproblems generated at once by the streamed decomposition", 1000),
+        _count_only("-count_only","only count the solutions, eps workers neither clone nor queue them", false),
+        _print_solutions("-print_solutions","printing of all the solutions (direct, writer thread, eps worker shards)", PRINT_DIRECT),
+        _portfolio("-portfolio","comma separated branching variants raced on the same subproblems by groups of eps workers"),
+        _lns_relax("-lns_relax","percentage of the integer variables relaxed by a neighbourhood of the lns search, one more after each neighbourhood without improvement", 30),
+        _lns_fails("-lns_fails","failures after which an lns neighbourhood is abandoned", 500),
+        _lns_neighbourhood("-lns_neighbourhood","variables relaxed by an lns neighbourhood (random, window)", LNS_RANDOM),
+        _warm_start("-warm_start","time box of the search of an incumbent before the eps decomposition, 0 for none (ms)", 0),
+        _warm_start_search("-warm_start_search","search of the incumbent before the eps decomposition (bab, lns)", WARM_START_BAB),
+        _deterministic("-deterministic","reproducible eps: sequential decomposition in fifo order, solutions and bounds committed in subproblem order", false),
+        _afc_decomposition("-afc_decomposition","record the failures of the eps decomposition in the afc of the branchings of the workers (no-op unless a branching selects by afc)", true) {
 
         //add suboptions
         _model.add(MODEL_FLATZINC, "flatzinc");
@@ -252,6 +399,7 @@ public:
         _search.add(FZ_SEARCH_EPS, "eps");
         _search.add(FZ_SEARCH_EPS_GRID_GENERATION, "eps_grid_generation");
         _search.add(FZ_SEARCH_EPS_GRID_COMPUTATION, "eps_grid_computation");
+        _search.add(FZ_SEARCH_LNS, "lns");
 
 
         //add options
@@ -281,6 +429,48 @@ public:
 
         add(_dl);
         add(_nspf);
+
+        add(_progress);
+        add(_progress_file);
+
+        _order.add(ORDER_FIFO, "fifo");
+        _order.add(ORDER_LPT, "lpt", "longest estimated subproblems first (optimization: only with -warm_start)");
+        add(_order);
+        add(_probe_nodes);
+
+        _affinity.add(AFFINITY_NONE, "none");
+        _affinity.add(AFFINITY_COMPACT, "compact");
+        _affinity.add(AFFINITY_SCATTER, "scatter");
+        add(_affinity);
+        add(_chunk_size);
+
+        _chunk.add(CHUNK_STATIC, "static");
+        _chunk.add(CHUNK_GUIDED, "guided");
+        _chunk.add(CHUNK_ADAPTIVE, "adaptive");
+        add(_chunk);
+        add(_chunk_time);
+        add(_memory_budget);
+        add(_stream_batch);
+        add(_count_only);
+
+        _print_solutions.add(PRINT_DIRECT, "direct");
+        _print_solutions.add(PRINT_WRITER, "writer");
+        _print_solutions.add(PRINT_SHARDS, "shards");
+        add(_print_solutions);
+        add(_portfolio);
+        add(_lns_relax);
+        add(_lns_fails);
+
+        _lns_neighbourhood.add(LNS_RANDOM, "random");
+        _lns_neighbourhood.add(LNS_WINDOW, "window");
+        add(_lns_neighbourhood);
+        add(_warm_start);
+
+        _warm_start_search.add(WARM_START_BAB, "bab");
+        _warm_start_search.add(WARM_START_LNS, "lns");
+        add(_warm_start_search);
+        add(_deterministic);
+        add(_afc_decomposition);
     }
 
     MyFlatZincOptions(const MyFlatZincOptions& o) : Gecode::FlatZinc::FlatZincOptions(o),
@@ -290,6 +480,7 @@ public:
         _propagation(o._propagation),
         _icl(o._icl),
         _branching(o._branching),
+        _branching_variants(o._branching_variants),
 
         _search(o._search),
         _problems(o._problems),
@@ -309,7 +500,28 @@ public:
 
         _cobj(o._cobj),
 
-        _dl(o._dl) {
+        _dl(o._dl),
+
+        _progress(o._progress),
+        _progress_file(o._progress_file),
+        _order(o._order),
+        _probe_nodes(o._probe_nodes),
+        _affinity(o._affinity),
+        _chunk_size(o._chunk_size),
+        _chunk(o._chunk),
+        _chunk_time(o._chunk_time),
+        _memory_budget(o._memory_budget),
+        _stream_batch(o._stream_batch),
+        _count_only(o._count_only),
+        _print_solutions(o._print_solutions),
+        _portfolio(o._portfolio),
+        _lns_relax(o._lns_relax),
+        _lns_fails(o._lns_fails),
+        _lns_neighbourhood(o._lns_neighbourhood),
+        _warm_start(o._warm_start),
+        _warm_start_search(o._warm_start_search),
+        _deterministic(o._deterministic),
+        _afc_decomposition(o._afc_decomposition) {
     }
 
     //-- Model
@@ -360,6 +572,13 @@ public:
         _branching.value(v);
     }
 
+    /// Name the branching variant \a v of the model \a o (for -portfolio)
+    inline void
+    branching(int v, const char* o, const char* h = NULL) {
+        _branching.add(v, o, h);
+        _branching_variants.push_back(std::make_pair(std::string(o), v));
+    }
+
 
     ModelOptions model(void) const {
         return static_cast<ModelOptions>(_model.value());
@@ -426,6 +645,96 @@ public:
         return _dl.value();
     }
 
+    unsigned int progress(void) const {
+        return _progress.value();
+    }
+
+    const char* progress_file(void) const {
+        return _progress_file.value();
+    }
+
+    OrderProblems order(void) const {
+        return static_cast<OrderProblems>(_order.value());
+    }
+
+    unsigned int probe_nodes(void) const {
+        return _probe_nodes.value();
+    }
+
+    AffinityOptions affinity(void) const {
+        return static_cast<AffinityOptions>(_affinity.value());
+    }
+
+    unsigned int chunk_size(void) const {
+        return _chunk_size.value();
+    }
+
+    ChunkOptions chunk(void) const {
+        return static_cast<ChunkOptions>(_chunk.value());
+    }
+
+    unsigned int chunk_time(void) const {
+        return _chunk_time.value();
+    }
+
+    unsigned int memory_budget(void) const {
+        return _memory_budget.value();
+    }
+
+    unsigned int stream_batch(void) const {
+        return _stream_batch.value();
+    }
+
+    bool count_only(void) const {
+        return _count_only.value();
+    }
+
+    PrintOptions print_solutions(void) const {
+        return static_cast<PrintOptions>(_print_solutions.value());
+    }
+
+    const char* portfolio(void) const {
+        return _portfolio.value();
+    }
+
+    /// Value of the branching variant named \a name, -1 if the model has no such variant
+    int branchingValue(const char* name) const {
+        for(size_t i = 0; i < _branching_variants.size(); i++) {
+            if(_branching_variants[i].first == name) {
+                return _branching_variants[i].second;
+            }
+        }
+        return -1;
+    }
+
+    unsigned int lns_relax(void) const {
+        return _lns_relax.value();
+    }
+
+    unsigned int lns_fails(void) const {
+        return _lns_fails.value();
+    }
+
+    LnsNeighbourhoods lns_neighbourhood(void) const {
+        return static_cast<LnsNeighbourhoods>(_lns_neighbourhood.value());
+    }
+
+    unsigned int warm_start(void) const {
+        return _warm_start.value();
+    }
+
+    WarmStartOptions warm_start_search(void) const {
+        return static_cast<WarmStartOptions>(_warm_start_search.value());
+    }
+
+    bool deterministic(void) const {
+        return _deterministic.value();
+    }
+
+    bool afc_decomposition(void) const {
+        return _afc_decomposition.value();
+    }
+
 
     ~MyFlatZincOptions() {}
 };
@@ -441,9 +750,31 @@ public:
     unsigned int _iterations_decomposition;
     unsigned int _nodes_decomposition;
     unsigned int _fails_decomposition;
-    unsigned int _memory_decomposition;
+    size_t _memory_decomposition;
+    size_t _memory_subproblems;
+    size_t _memory_space;
+    unsigned int _memory_limited;
     unsigned int _time_max_inactivity;
+    double _time_limit_stop;
+    unsigned long int _count_solutions;
+    unsigned long int _lns_neighbourhoods;
+    unsigned long int _lns_improvements;
+    /// Worker and subproblem which found the solution (-1 if unknown)
+    int _solution_worker;
+    int _solution_subproblem;
+    /// Time the solution was found in ms from the start of the run (-1 if unknown)
+    double _solution_time;
+    /// Clock of the run, read by the workers to date their solutions (NULL if none)
+    Gecode::Support::Timer* _timer_run;
+    /// Time the eps workers waited for the deterministic bounds (in ms)
+    double _time_deterministic_wait;
+    /// Peak number of results held to be reported in subproblem order (solutions, or finished subproblems when optimizing)
+    size_t _deterministic_held;
     std::vector< std::vector<unsigned int> >* _time_subproblems_workers;
+    std::vector<size_t>* _memory_workers;
+    EngineLockStatistics* _lock_statistics;
+    std::vector< std::vector<SubProblemTrace> >* _trace_subproblems_workers;
+    std::vector<unsigned int>* _portfolio_wins;
     std::string* _name_instance;
     /*
     /// The integer variables
@@ -502,8 +833,25 @@ public:
         _nodes_decomposition(0),
         _fails_decomposition(0),
         _memory_decomposition(0),
+        _memory_subproblems(0),
+        _memory_space(0),
+        _memory_limited(0),
         _time_max_inactivity(0),
+        _time_limit_stop(-1.0),
+        _count_solutions(0),
+        _lns_neighbourhoods(0),
+        _lns_improvements(0),
+        _solution_worker(-1),
+        _solution_subproblem(-1),
+        _solution_time(-1.0),
+        _timer_run(NULL),
+        _time_deterministic_wait(0.0),
+        _deterministic_held(0),
         _time_subproblems_workers(NULL),
+        _memory_workers(NULL),
+        _lock_statistics(NULL),
+        _trace_subproblems_workers(NULL),
+        _portfolio_wins(NULL),
         _name_instance(NULL)
         //,filter_iv(NULL), filter_bv(NULL), filter_sv(NULL), filter_fv(NULL)
     {
@@ -524,7 +872,8 @@ public:
              const MyFlatZincOptions& opt, Gecode::Support::Timer& t_total);
 
 
-    void createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed, double decay,
+    /// Post the branchings of the solve annotations, true if one of them selects its variables by afc
+    bool createBranchers(Gecode::FlatZinc::AST::Node* ann, int seed, double decay,
                          bool ignoreUnknown,
                          std::ostream& err);
 
@@ -533,8 +882,21 @@ public:
 
     void sortVariables(bool less = true);
 
+    /// Record that worker \a worker found this solution in subproblem \a subproblem, now
+    void stampSolution(int worker, int subproblem);
+
     virtual void createBranchers() {}
 
+    /// Whether the branchings posted by createBranchers() select their variables by afc
+    virtual bool afcBranchers(void) const {
+        return false;
+    }
+
+    /// Post the branchings of variant \a branching (see -branching), false if the model has no variants
+    virtual bool createBranchers(int branching) {
+        return false;
+    }
+
 protected:
     MyFlatZincSpace(bool share, MyFlatZincSpace& f);
 
@@ -0,0 +1,294 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* frontier.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <algorithm>
+
+#include "flatzinc.h"
+#include "frontier.h"
+
+ExpandStatus
+expandPrefix(MyFlatZincSpace* root, Prefix& p, std::vector<Prefix>& children) {
+    children.clear();
+
+    unsigned int nb_bool = root->bv.size();
+    unsigned int nb_decision_variables = nb_bool + root->iv.size();
+
+    MyFlatZincSpace* s = static_cast<MyFlatZincSpace*>(root->clone(false));
+    for(unsigned int i = 0; i < p.size(); i++) {
+        if(i < nb_bool) {
+            Gecode::rel(*s, s->bv[i], Gecode::IRT_EQ, p[i]);
+        } else {
+            Gecode::rel(*s, s->iv[i - nb_bool], Gecode::IRT_EQ, p[i]);
+        }
+    }
+
+    if(s->status() == Gecode::SS_FAILED) {
+        delete s;
+        return EXPAND_FAILED;
+    }
+
+    //Skip the variables assigned by propagation
+    unsigned int level = p.size();
+    while(level < nb_decision_variables) {
+        if(level < nb_bool) {
+            if(!s->bv[level].assigned()) {
+                break;
+            }
+            p.push_back(s->bv[level].val());
+        } else {
+            if(!s->iv[level - nb_bool].assigned()) {
+                break;
+            }
+            p.push_back(s->iv[level - nb_bool].val());
+        }
+        level++;
+    }
+
+    if(level == nb_decision_variables) {
+        delete s;
+        return EXPAND_LEAF;
+    }
+
+    Prefix child(p);
+    child.push_back(0);
+    if(level < nb_bool) {
+        for(int a = s->bv[level].min(); a <= s->bv[level].max(); a++) {
+            child.back() = a;
+            children.push_back(child);
+        }
+    } else {
+        for(Gecode::IntVarValues i(s->iv[level - nb_bool]); i(); ++i) {
+            child.back() = i.val();
+            children.push_back(child);
+        }
+    }
+
+    delete s;
+    return EXPAND_CHILDREN;
+}
+
+Frontier::Frontier(unsigned int target, size_t budget)
+    : _target(std::max(target, 1u)), _expanding(0), _closed(false), _budget(budget), _limited(false),
+      _nodes(0), _fails(0), _depth(0),
+      _nodes_held(1), _values_held(0), _nodes_peak(1), _values_peak(0) {
+    _open.push_back(Prefix());
+}
+
+void
+Frontier::hold(long int nodes, long int values) {
+    _nodes_held += nodes;
+    _values_held += values;
+    if(_nodes_held > _nodes_peak) {
+        _nodes_peak = _nodes_held;
+    }
+    if(_values_held > _values_peak) {
+        _values_peak = _values_held;
+    }
+}
+
+bool
+Frontier::pop(Prefix& p) {
+    while(true) {
+        _m.acquire();
+        if(_closed || (_open.empty() && _expanding == 0)) {
+            _m.release();
+            return false;
+        }
+        if(!_open.empty()) {
+            _limited = _budget && static_cast<size_t>(_values_held) * sizeof(int)
+                       + static_cast<size_t>(_nodes_held) * sizeof(Prefix) >= _budget;
+            if(_limited || _open.size() + _leaves.size() + _expanding >= _target) {
+                //Enough subproblems, the expansions in progress publish leaves
+                _leaves.insert(_leaves.end(), _open.begin(), _open.end());
+                _open.clear();
+                _closed = true;
+                _m.release();
+                return false;
+            }
+            p = _open.front();
+            _open.pop_front();
+            _expanding++;
+            _m.release();
+            return true;
+        }
+        //Wait for the children of the nodes being expanded
+        _m.release();
+        Gecode::Support::Thread::sleep(1);
+    }
+}
+
+void
+Frontier::push(const Prefix& p, ExpandStatus status, const std::vector<Prefix>& children) {
+    _m.acquire();
+    _expanding--;
+    _nodes++;
+    switch(status) {
+    case EXPAND_FAILED:
+        _fails++;
+        hold(-1, -static_cast<long int>(p.size()));
+        break;
+    case EXPAND_LEAF:
+        _leaves.push_back(p);
+        break;
+    case EXPAND_CHILDREN:
+        //The node is replaced by its children
+        hold(static_cast<long int>(children.size()) - 1,
+             static_cast<long int>(children.size() * (p.size() + 1)) - static_cast<long int>(p.size()));
+        if(_closed) {
+            _leaves.insert(_leaves.end(), children.begin(), children.end());
+        } else {
+            _open.insert(_open.end(), children.begin(), children.end());
+        }
+        break;
+    }
+    if(_depth < p.size() + (status == EXPAND_CHILDREN ? 1 : 0)) {
+        _depth = p.size() + (status == EXPAND_CHILDREN ? 1 : 0);
+    }
+    _m.release();
+}
+
+void
+Frontier::groups(unsigned int nb_bool, std::vector<FrontierGroup>& g) {
+    groupPrefixes(_leaves, nb_bool, g);
+}
+
+void
+groupPrefixes(std::vector<Prefix>& leaves, unsigned int nb_bool, std::vector<FrontierGroup>& g) {
+    g.clear();
+
+    //Search order, so that consecutive subproblems share their prefix
+    std::sort(leaves.begin(), leaves.end());
+
+    std::vector< std::vector<const Prefix*> > depths;
+    for(size_t i = 0; i < leaves.size(); i++) {
+        if(depths.size() <= leaves[i].size()) {
+            depths.resize(leaves[i].size() + 1);
+        }
+        depths[leaves[i].size()].push_back(&leaves[i]);
+    }
+
+    for(size_t d = 0; d < depths.size(); d++) {
+        if(depths[d].empty()) {
+            continue;
+        }
+        FrontierGroup group;
+        group.size = depths[d].size();
+        unsigned int arity_bool = std::min<unsigned int>(d, nb_bool);
+        for(size_t i = 0; i < depths[d].size(); i++) {
+            const Prefix& p = *depths[d][i];
+            if(arity_bool) {
+                group.tuples_bool.add(Gecode::IntArgs(arity_bool, &p[0]));
+            }
+            if(d > arity_bool) {
+                group.tuples_int.add(Gecode::IntArgs(d - arity_bool, &p[arity_bool]));
+            }
+        }
+        group.tuples_bool.finalize();
+        group.tuples_int.finalize();
+        g.push_back(group);
+    }
+}
+
+PrefixStream::PrefixStream(MyFlatZincSpace* root, unsigned int target)
+    : _root(root), _depth(0), _nodes(0), _fails(0), _values_held(0), _values_peak(0) {
+    unsigned int nb_bool = _root->bv.size();
+    unsigned int nb_decision_variables = nb_bool + _root->iv.size();
+
+    //Shallowest depth whose nodes are enough subproblems, as the first level of DBDFS
+    if(_root->status() != Gecode::SS_FAILED) {
+        double product_domain = 1.0;
+        while(_depth < nb_decision_variables && product_domain < target) {
+            if(_depth < nb_bool) {
+                product_domain *= _root->bv[_depth].size();
+            } else {
+                product_domain *= _root->iv[_depth - nb_bool].size();
+            }
+            _depth++;
+        }
+        _open.push_back(Prefix());
+    }
+}
+
+PrefixStream::~PrefixStream(void) {
+    delete _root;
+}
+
+bool
+PrefixStream::next(Prefix& p) {
+    std::vector<Prefix> children;
+    while(!_open.empty()) {
+        p.swap(_open.back());
+        _open.pop_back();
+        _values_held -= p.size();
+        _nodes++;
+
+        switch(expandPrefix(_root, p, children)) {
+        case EXPAND_FAILED:
+            _fails++;
+            break;
+        case EXPAND_LEAF:
+            return true;
+        case EXPAND_CHILDREN:
+            if(p.size() >= _depth) {
+                return true;
+            }
+            //Reverse order, the first child is expanded next
+            for(size_t i = children.size(); i-- > 0;) {
+                _values_held += children[i].size();
+                _open.push_back(Prefix());
+                _open.back().swap(children[i]);
+            }
+            if(_values_held > _values_peak) {
+                _values_peak = _values_held;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+unsigned int
+PrefixStream::batch(unsigned int n, unsigned int nb_bool, std::vector<FrontierGroup>& g) {
+    std::vector<Prefix> leaves;
+    Prefix p;
+    while(leaves.size() < n && next(p)) {
+        leaves.push_back(p);
+    }
+    groupPrefixes(leaves, nb_bool, g);
+    return leaves.size();
+}
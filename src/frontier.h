@@ -0,0 +1,218 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* frontier.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __FRONTIER_H__
+#define __FRONTIER_H__
+
+#include <gecode/int.hh>
+
+#include <vector>
+#include <deque>
+
+class MyFlatZincSpace;
+
+/// Node of the decomposition: values of the first decision variables (bool variables first)
+typedef std::vector<int> Prefix;
+
+/// Result of the expansion of a node
+enum ExpandStatus {
+    EXPAND_FAILED,  //< the node has no solution
+    EXPAND_LEAF,    //< every decision variable is assigned
+    EXPAND_CHILDREN //< the node branches on its next decision variable
+};
+
+/**
+ * \brief Expand node \a p on a clone of \a root
+ *
+ * The decision variables assigned by the propagation of \a p extend it,
+ * the children branch on the values of the next decision variable.
+ */
+ExpandStatus expandPrefix(MyFlatZincSpace* root, Prefix& p, std::vector<Prefix>& children);
+
+/// Leaves of the same depth, the tuples of one group of subproblems
+struct FrontierGroup {
+    Gecode::TupleSet tuples_bool;
+    Gecode::TupleSet tuples_int;
+    /// Number of leaves (one tuple each)
+    unsigned int size;
+};
+
+/// Group \a leaves by depth in search order, for \a nb_bool bool decision variables
+void groupPrefixes(std::vector<Prefix>& leaves, unsigned int nb_bool, std::vector<FrontierGroup>& g);
+
+/**
+ * \brief Frontier of a decomposition shared by the workers
+ *
+ * Starting from the root, any worker takes an open node, expands it and
+ * publishes its children, until the open nodes and the leaves reach the
+ * targeted number of subproblems. The open nodes then become leaves.
+ */
+class Frontier {
+public:
+    /**
+     * \brief Frontier holding the root, expanded up to \a target subproblems
+     *
+     * The expansion also stops once the nodes held reach \a budget bytes
+     * (0 for no budget).
+     */
+    Frontier(unsigned int target, size_t budget = 0);
+
+    /**
+     * \brief Take an open node to expand in \a p
+     *
+     * Waits while the frontier is empty and other workers expand nodes,
+     * returns false once the decomposition is over.
+     */
+    bool pop(Prefix& p);
+
+    /// Publish the expansion of the node \a p taken by pop
+    void push(const Prefix& p, ExpandStatus status, const std::vector<Prefix>& children);
+
+    /// Leaves grouped by depth, in search order, for \a nb_bool bool decision variables
+    void groups(unsigned int nb_bool, std::vector<FrontierGroup>& g);
+
+    /// Number of expanded nodes
+    unsigned long int nodes(void) const {
+        return _nodes;
+    }
+
+    /// Number of failed nodes
+    unsigned long int fails(void) const {
+        return _fails;
+    }
+
+    /// Depth of the deepest leaf
+    unsigned int depth(void) const {
+        return _depth;
+    }
+
+    /// Whether the expansion was stopped by the memory budget
+    bool limited(void) const {
+        return _limited;
+    }
+
+    /// Peak memory of the nodes held by the frontier (in bytes)
+    size_t memory(void) const {
+        return static_cast<size_t>(_values_peak) * sizeof(int) + static_cast<size_t>(_nodes_peak) * sizeof(Prefix);
+    }
+
+private:
+    Gecode::Support::Mutex _m;
+    unsigned int _target;
+    /// Nodes waiting for an expansion (breadth first)
+    std::deque<Prefix> _open;
+    /// Subproblems of the decomposition
+    std::vector<Prefix> _leaves;
+    /// Nodes being expanded
+    unsigned int _expanding;
+    /// Set once the target is reached
+    bool _closed;
+    size_t _budget;
+    bool _limited;
+
+    unsigned long int _nodes;
+    unsigned long int _fails;
+    unsigned int _depth;
+
+    /// Record the nodes and values held (lock held)
+    void hold(long int nodes, long int values);
+    /// Nodes and values held, open, expanding or leaves
+    long int _nodes_held;
+    long int _values_held;
+    long int _nodes_peak;
+    long int _values_peak;
+};
+
+/**
+ * \brief Decomposition generated lazily, in DBDFS order
+ *
+ * The nodes of the first depth holding \a target subproblems are
+ * enumerated depth first, only the open nodes of the expansion are held.
+ * The memory grows with the depth and the domains of the decomposition,
+ * not with the number of subproblems. Not thread safe.
+ */
+class PrefixStream {
+public:
+    /// Stream of the subproblems of \a root (owned by the stream)
+    PrefixStream(MyFlatZincSpace* root, unsigned int target);
+    ~PrefixStream(void);
+
+    /// Next subproblem in \a p, false once the decomposition is over
+    bool next(Prefix& p);
+
+    /// Group the next \a n subproblems (at most) in \a g, returns their number
+    unsigned int batch(unsigned int n, unsigned int nb_bool, std::vector<FrontierGroup>& g);
+
+    /// Whether every subproblem was generated
+    bool done(void) const {
+        return _open.empty();
+    }
+
+    /// Number of expanded nodes
+    unsigned long int nodes(void) const {
+        return _nodes;
+    }
+
+    /// Number of failed nodes
+    unsigned long int fails(void) const {
+        return _fails;
+    }
+
+    /// Depth of the subproblems
+    unsigned int depth(void) const {
+        return _depth;
+    }
+
+    /// Peak memory of the open nodes (in bytes)
+    size_t memory(void) const {
+        return _values_peak * sizeof(int);
+    }
+
+private:
+    MyFlatZincSpace* _root;
+    unsigned int _depth;
+    /// Open nodes, the next one last
+    std::vector<Prefix> _open;
+
+    unsigned long int _nodes;
+    unsigned long int _fails;
+    size_t _values_held;
+    size_t _values_peak;
+};
+
+#endif /* __FRONTIER_H__ */
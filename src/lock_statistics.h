@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* lock_statistics.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __LOCK_STATISTICS_H__
+#define __LOCK_STATISTICS_H__
+
+#include <gecode/support.hh>
+
+/// Duration of a repeated operation (in ms)
+struct DurationStatistics {
+    /// Number of measured operations
+    unsigned long int count;
+    /// Sum of the durations
+    double total;
+    /// Longest duration
+    double max;
+
+    DurationStatistics(void)
+        : count(0), total(0.0), max(0.0) {
+    }
+
+    /// Record an operation which lasted \a ms
+    void add(double ms) {
+        count++;
+        total += ms;
+        if(ms > max) {
+            max = ms;
+        }
+    }
+
+    /// Add the operations measured by \a d
+    void merge(const DurationStatistics& d) {
+        count += d.count;
+        total += d.total;
+        if(d.max > max) {
+            max = d.max;
+        }
+    }
+
+    /// Average duration (0 if nothing was measured)
+    double average(void) const {
+        return count ? total / count : 0.0;
+    }
+};
+
+/**
+ * \brief Contention of a mutex
+ *
+ * The counters are only updated once the mutex is held, so they need no
+ * extra synchronization. An uncontended acquisition costs a tryacquire,
+ * the wait is only timed when the mutex is already taken.
+ */
+struct LockStatistics {
+    /// Number of acquisitions
+    unsigned long int acquisitions;
+    /// Time spent waiting for the mutex (contended acquisitions only)
+    DurationStatistics wait;
+
+    LockStatistics(void)
+        : acquisitions(0) {
+    }
+
+    /// Acquire \a m and record the time spent waiting
+    void acquire(Gecode::Support::Mutex& m) {
+        if(m.tryacquire()) {
+            acquisitions++;
+            return;
+        }
+        Gecode::Support::Timer t;
+        t.start();
+        m.acquire();
+        acquisitions++;
+        wait.add(t.stop());
+    }
+};
+
+/// Contention of the locks of an eps engine
+struct EngineLockStatistics {
+    /// Lock protecting the subproblems to solve
+    LockStatistics findjob_resolution;
+    /// Lock protecting the subproblems to decompose
+    LockStatistics findjob_decomposition;
+    /// Lock protecting the solutions reported by the workers
+    LockStatistics search;
+    /// Time to hand a subproblem to a worker (clone and constraint posting)
+    DurationStatistics dispatch;
+};
+
+#endif /* __LOCK_STATISTICS_H__ */
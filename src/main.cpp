@@ -211,6 +211,13 @@ int main(int argc, char** argv) {
     MyFlatZincOptions opt("Gecode/MyFlatZinc");
     opt.parse(argc, argv);
 
+    //The eps workers restart inside their subproblems, a constant cutoff would never finish one
+    if(opt.restart() == RM_CONSTANT && (opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS
+                                        || opt.search() == MyFlatZincOptions::FZ_SEARCH_EPS_GRID_GENERATION)) {
+        cerr << "-restart constant is not supported by the eps search (use linear, luby or geometric)" << endl;
+        exit(EXIT_FAILURE);
+    }
+
 
     //std::cerr << opt.solutions() << std::endl;
 
@@ -234,7 +241,7 @@ int main(int argc, char** argv) {
             fg = new MyFlatZincSpace(); //mandatory
             fg = static_cast<MyFlatZincSpace*>(FlatZinc::parse(cin, p, cerr, fg));
 
-            if(opt.search() != MyFlatZincOptions::FZ_SEARCH_BAB) {
+            if(opt.search() != MyFlatZincOptions::FZ_SEARCH_BAB && opt.search() != MyFlatZincOptions::FZ_SEARCH_LNS) {
                 fg_copy = new MyFlatZincSpace();
                 fg_copy = static_cast<MyFlatZincSpace*>(FlatZinc::parse(cin, p1, cerr, fg_copy));
             }
@@ -242,7 +249,7 @@ int main(int argc, char** argv) {
             fg = new MyFlatZincSpace(); //mandatory
             fg = static_cast<MyFlatZincSpace*>(FlatZinc::parse(filename, p, cerr, fg));
 
-            if(opt.search() != MyFlatZincOptions::FZ_SEARCH_BAB) {
+            if(opt.search() != MyFlatZincOptions::FZ_SEARCH_BAB && opt.search() != MyFlatZincOptions::FZ_SEARCH_LNS) {
                 fg_copy = new MyFlatZincSpace();
                 fg_copy = static_cast<MyFlatZincSpace*>(FlatZinc::parse(filename, p1, cerr, fg_copy));
             }
@@ -378,7 +385,8 @@ int main(int argc, char** argv) {
 
 
 
-        if(opt.search() == MyFlatZincOptions::FZ_SEARCH_BAB) {
+        //The lns workers search the space with its branchings, no decomposition
+        if(opt.search() == MyFlatZincOptions::FZ_SEARCH_BAB || opt.search() == MyFlatZincOptions::FZ_SEARCH_LNS) {
             //Use BranchFilter to remove variable in branching
             //::memcpy(&p1, &p, sizeof(FlatZinc::Printer)); <!-- does not work
 
@@ -411,8 +419,9 @@ int main(int argc, char** argv) {
             //Problem d'objective il faut mettre <= 21 pas failed !!!!!!
             fg->_space_hook = static_cast<MyFlatZincSpace*>(fg->clone(false));
 
+            bool afc;
             if(opt.model() == MyFlatZincOptions::MODEL_FLATZINC) {
-                fg->createBranchers(fg->solveAnnotations(), opt.seed(), opt.decay(), false, std::cerr);
+                afc = fg->createBranchers(fg->solveAnnotations(), opt.seed(), opt.decay(), false, std::cerr);
                 //branch(*fg, fg->iv, TieBreak<IntVarBranch>(INT_VAR_NONE()), Gecode::INT_VAL_MIN());
                 //branch(*fg, fg->bv, TieBreak<IntVarBranch>(INT_VAR_NONE()), Gecode::INT_VAL_MIN());
 
@@ -432,7 +441,15 @@ int main(int argc, char** argv) {
             } else {
 
                 fg->createBranchers();
+                afc = fg->afcBranchers();
+
+            }
 
+            if(opt.afc_decomposition() && afc) {
+                //The hook was cloned before the branchers, so it does not record the failures.
+                //Its propagators share their afc with the clones of fg: the failures of the
+                //decomposition then inform the afc branchings of the workers from their first node
+                fg->_space_hook->afc_decay(opt.decay());
             }
 
             //std::cerr << "number of variables int models : " << fg->iv.size() << std::endl;
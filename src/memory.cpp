@@ -0,0 +1,86 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* memory.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <sys/resource.h>
+
+#include "allocator.h"
+#include "memory.h"
+
+size_t
+tupleSetMemory(const Gecode::TupleSet& t) {
+    //The tuples are only counted once finalized
+    if(!t.finalized() || t.tuples() <= 0) {
+        return 0;
+    }
+    //Values of the tuples and the pointer to each of them
+    return static_cast<size_t>(t.tuples()) * (t.arity() * sizeof(int) + sizeof(int*));
+}
+
+size_t
+spaceMemory(const Gecode::Space* s) {
+    size_t before = allocatorStatistics().allocated;
+    Gecode::Space* c = s->clone(false);
+    size_t after = allocatorStatistics().allocated;
+    delete c;
+    return after > before ? after - before : 0;
+}
+
+size_t
+peakResidentMemory(void) {
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    //Kilobytes on Linux
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+void
+MemoryPeak::start(void) {
+    _peak = 0;
+    if(allocatorThreadCounters(_allocated, _deallocated)) {
+        _base = static_cast<int64_t>(*_allocated - *_deallocated);
+    } else {
+        _allocated = NULL;
+        _deallocated = NULL;
+    }
+}
@@ -0,0 +1,108 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* memory.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __MEMORY_H__
+#define __MEMORY_H__
+
+#include <gecode/kernel.hh>
+#include <gecode/int.hh>
+
+#include <cstddef>
+#include <stdint.h>
+
+/// Memory of the tuples of \a t (in bytes, 0 until it is finalized)
+size_t tupleSetMemory(const Gecode::TupleSet& t);
+
+/**
+ * \brief Memory of a clone of \a s (in bytes)
+ *
+ * Measured by the allocator around a clone, so no other thread may
+ * allocate meanwhile. Returns 0 when the allocator gives no statistics.
+ */
+size_t spaceMemory(const Gecode::Space* s);
+
+/// High-water mark of the resident memory of the process (in bytes)
+size_t peakResidentMemory(void);
+
+/**
+ * \brief Peak of the memory held by a thread
+ *
+ * Built with jemalloc, the bytes allocated and not freed by the thread
+ * since start() are read from its counters. Otherwise the estimate given
+ * to sample() is recorded.
+ */
+class MemoryPeak {
+public:
+    MemoryPeak(void)
+        : _allocated(NULL), _deallocated(NULL), _base(0), _peak(0) {
+    }
+
+    /// Start measuring the calling thread
+    void start(void);
+
+    /// Whether the memory is measured rather than estimated
+    bool exact(void) const {
+        return _allocated != NULL;
+    }
+
+    /// Record the memory currently held, \a estimate when it is not measured
+    void sample(size_t estimate) {
+        size_t m = estimate;
+        if(_allocated) {
+            int64_t live = static_cast<int64_t>(*_allocated - *_deallocated) - _base;
+            //Memory allocated by other threads may be freed by this one
+            m = live > 0 ? static_cast<size_t>(live) : 0;
+        }
+        if(m > _peak) {
+            _peak = m;
+        }
+    }
+
+    /// Peak memory (in bytes)
+    size_t peak(void) const {
+        return _peak;
+    }
+
+private:
+    const uint64_t* _allocated;
+    const uint64_t* _deallocated;
+    int64_t _base;
+    size_t _peak;
+};
+
+#endif /* __MEMORY_H__ */
@@ -2262,10 +2262,10 @@ public:
         opt.name(name_instance.c_str());
 
         opt.branching(BACP::BRANCHING_NAIVE);
-        /*
         opt.branching(BACP::BRANCHING_NAIVE,"naive");
         opt.branching(BACP::BRANCHING_LOAD,"load");
         opt.branching(BACP::BRANCHING_LOAD_REV,"load-reverse");
+        /*
         opt.size(2);
         */
 
@@ -2355,6 +2355,12 @@ public:
             break;
         }
     }
+    /// Post the branchings of variant \a branching
+    bool createBranchers(int branching) {
+        br = static_cast<branch_opt>(branching);
+        createBranchers();
+        return true;
+    }
     /// Value selection function for load branching
     static int load(const Space& home, IntVar x, int) {
         const BACP& b = static_cast<const BACP&>(home);
@@ -2389,7 +2395,7 @@ public:
     }
     /// Constructor for copying \a bacp
     BACP(bool share, BACP& bacp) : MyFlatZincSpace(share,bacp),
-        curr(bacp.curr) {
+        curr(bacp.curr), br(bacp.br) {
         l.update(*this, share, bacp.l);
         //u.update(*this, share, bacp.u);
         //x.update(*this, share, bacp.x);
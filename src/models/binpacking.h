@@ -401,6 +401,8 @@ public:
     static MyFlatZincSpace* getInstance(MyFlatZincOptions& opt, const char* instance) {
 
         opt.branching(BRANCH_CDBF);
+        opt.branching(BRANCH_NAIVE, "naive");
+        opt.branching(BRANCH_CDBF, "cdbf");
 
         return new BinPacking(opt, instance);
     }
@@ -528,9 +530,16 @@ public:
 
     }
 
+    /// Post the branchings of variant \a branching
+    bool createBranchers(int branching) {
+        br = static_cast<enum branch_opt>(branching);
+        createBranchers();
+        return true;
+    }
+
     /// Constructor for cloning \a s
     BinPacking(bool share, BinPacking& s)
-        : MyFlatZincSpace(share,s), spec(s.spec) {
+        : MyFlatZincSpace(share,s), spec(s.spec), br(s.br) {
         load.update(*this, share, s.load);
         //bin = s.bin;
         //bins = s.bins;
@@ -340,7 +340,7 @@ public:
         BRANCH_SIZE_AFC,    ///< Choose variable with smallest size/degree
     } br;
 
-    int decay;
+    double decay;
 
     static MyFlatZincSpace* getInstance(MyFlatZincOptions& opt) {
 
@@ -357,11 +357,11 @@ public:
         opt.model(GraphColor::MODEL_CLIQUE, "clique",
                   "use maximal clique size as lower bound");
         opt.branching(GraphColor::BRANCH_DEGREE);
+        */
         opt.branching(GraphColor::BRANCH_DEGREE, "degree");
         opt.branching(GraphColor::BRANCH_SIZE, "size");
         opt.branching(GraphColor::BRANCH_SIZE_DEGREE, "sizedegree");
         opt.branching(GraphColor::BRANCH_SIZE_AFC, "sizeafc");
-        */
 
         opt.branching(GraphColor::BRANCH_SIZE_DEGREE);
         //opt.model(GraphColor::MODEL_CLIQUE);
@@ -444,8 +444,18 @@ public:
             break;
         }
     }
+    /// Post the branchings of variant \a branching
+    bool createBranchers(int branching) {
+        br = static_cast<branch_graph_color>(branching);
+        createBranchers();
+        return true;
+    }
+    /// Only the sizeafc variant selects by afc
+    bool afcBranchers(void) const {
+        return br == BRANCH_SIZE_AFC;
+    }
     /// Constructor for cloning \a s
-    GraphColor(bool share, GraphColor& s) : MyFlatZincSpace(share,s), g(s.g) {
+    GraphColor(bool share, GraphColor& s) : MyFlatZincSpace(share,s), g(s.g), br(s.br), decay(s.decay) {
         //v.update(*this, share, s.v);
         //m.update(*this, share, s.m);
     }
@@ -60,7 +60,7 @@ protected:
     //IntVarArray y;
     int n;
 public:
-    int decay;
+    double decay;
 
     static MyFlatZincSpace* getInstance(MyFlatZincOptions& opt) {
 
@@ -155,6 +155,10 @@ public:
         //branch(*this, iv, INT_VAR_NONE(), INT_VAL_MAX());
     }
 
+    bool afcBranchers(void) const {
+        return true;
+    }
+
 
     /// Constructor used during cloning \a s
     Partition(bool share, Partition& s) : MyFlatZincSpace(share,s), n(s.n) {
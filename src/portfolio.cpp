@@ -0,0 +1,84 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* portfolio.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <algorithm>
+
+#include "portfolio.h"
+
+Portfolio::Portfolio(const std::vector<int>& branchings, unsigned int workers)
+    : _branchings(branchings.begin(), branchings.begin() + std::min<size_t>(branchings.size(), workers)),
+      _cursor(_branchings.size(), 0),
+      _solving(workers, -1) {
+}
+
+int
+Portfolio::take(unsigned int w, unsigned int n) {
+    unsigned int& c = _cursor[group(w)];
+    while(c < n && c < _won.size() && _won[c]) {
+        c++;
+    }
+    if(c >= n) {
+        return -1;
+    }
+    if(_won.size() < n) {
+        _won.resize(n, false);
+    }
+    _solving[w] = c;
+    return c++;
+}
+
+bool
+Portfolio::finish(unsigned int w, std::vector<unsigned int>& losers) {
+    int i = _solving[w];
+    _solving[w] = -1;
+    if(_won[i]) {
+        return false;
+    }
+    _won[i] = true;
+    for(unsigned int v = 0; v < _solving.size(); v++) {
+        if(_solving[v] == i) {
+            losers.push_back(v);
+        }
+    }
+    return true;
+}
+
+void
+Portfolio::drop(unsigned int w) {
+    _solving[w] = -1;
+}
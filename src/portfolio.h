@@ -0,0 +1,87 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* portfolio.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __PORTFOLIO_H__
+#define __PORTFOLIO_H__
+
+#include <vector>
+
+/**
+ * \brief Race of branchings on the same subproblems
+ *
+ * The workers are split in groups, one per branching. Every group goes
+ * through all the subproblems in dispatch order, the first group to finish
+ * a subproblem wins it: the other groups skip it or drop it. All the
+ * methods are called with the lock of resolution held.
+ */
+class Portfolio {
+public:
+    /// Race of \a branchings by \a workers workers (at most one group per worker)
+    Portfolio(const std::vector<int>& branchings, unsigned int workers);
+
+    /// Number of groups
+    unsigned int groups(void) const {
+        return _branchings.size();
+    }
+    /// Group of worker \a w
+    unsigned int group(unsigned int w) const {
+        return w % _branchings.size();
+    }
+    /// Branching of group \a g
+    int branching(unsigned int g) const {
+        return _branchings[g];
+    }
+
+    /// Subproblem among the \a n first ones raced next by worker \a w, -1 if its group reached the end
+    int take(unsigned int w, unsigned int n);
+    /// Worker \a w finished its subproblem, false if another group won it; the workers to cancel are added to \a losers
+    bool finish(unsigned int w, std::vector<unsigned int>& losers);
+    /// Worker \a w dropped its subproblem
+    void drop(unsigned int w);
+
+private:
+    std::vector<int> _branchings;
+    /// Next subproblem of each group
+    std::vector<unsigned int> _cursor;
+    /// Subproblem solved by each worker (-1 if none)
+    std::vector<int> _solving;
+    /// Whether each subproblem is won
+    std::vector<bool> _won;
+};
+
+#endif /* __PORTFOLIO_H__ */
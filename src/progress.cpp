@@ -0,0 +1,207 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* progress.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+#include "progress.h"
+
+/// Thread printing periodically the progress of an eps search
+class ProgressReporter : public Gecode::Support::Runnable {
+private:
+    ProgressMonitor& _monitor;
+    unsigned int _interval;
+    std::string _file;
+
+    Gecode::Support::Timer _timer;
+    double _last_time;
+    std::vector<unsigned long int> _last_nodes;
+    unsigned int _last_finished;
+    /// Smoothed throughput in subproblems per second
+    double _rate;
+
+public:
+    ProgressReporter(ProgressMonitor& m, unsigned int interval, const std::string& file)
+        : _monitor(m), _interval(interval), _file(file),
+          _last_time(0.0), _last_nodes(m.workers(), 0), _last_finished(0), _rate(0.0) {
+    }
+
+    /// Write one report
+    void report(void);
+
+    virtual void run(void);
+};
+
+void
+ProgressReporter::report(void) {
+    double now = _timer.stop();
+    double dt = (now - _last_time) / 1000.0;
+    _last_time = now;
+
+    unsigned int n = _monitor.workers();
+    unsigned int finished = 0;
+    unsigned int idle = 0;
+    double total_nps = 0.0;
+    double min_nps = 0.0;
+    double max_nps = 0.0;
+    std::vector<double> nps(n, 0.0);
+
+    for (unsigned int i = 0; i < n; i++) {
+        const WorkerProgress& w = _monitor.worker(i);
+        unsigned long int nodes = w.nodes;
+        finished += w.problems;
+        if (w.idle)
+            idle++;
+
+        if (dt > 0.0 && nodes >= _last_nodes[i])
+            nps[i] = (nodes - _last_nodes[i]) / dt;
+        _last_nodes[i] = nodes;
+
+        total_nps += nps[i];
+        if (i == 0 || nps[i] < min_nps)
+            min_nps = nps[i];
+        if (i == 0 || nps[i] > max_nps)
+            max_nps = nps[i];
+    }
+
+    if (dt > 0.0 && finished >= _last_finished) {
+        double rate = (finished - _last_finished) / dt;
+        _rate = (_rate == 0.0) ? rate : 0.7 * _rate + 0.3 * rate;
+    }
+    _last_finished = finished;
+
+    unsigned int problems = _monitor.problems;
+    bool decomposed = _monitor.decomposed;
+    unsigned int remaining = problems > finished ? problems - finished : 0;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1)
+         << "%% progress " << now / 1000.0 << " s :"
+         << " problems " << problems << (decomposed ? "" : " (decomposing)")
+         << " dispatched " << _monitor.dispatched
+         << " finished " << finished
+         << " remaining " << remaining
+         << " idle " << idle << "/" << n
+         << std::setprecision(0)
+         << " nodes/s " << total_nps << " [min " << min_nps << " max " << max_nps << "]"
+         << " solutions " << _monitor.solutions;
+    if (_monitor.has_incumbent)
+        line << " incumbent " << _monitor.incumbent;
+    line << std::setprecision(1) << " eta ";
+    if (decomposed && remaining == 0)
+        line << "0.0 s";
+    else if (decomposed && _rate > 0.0)
+        line << remaining / _rate << " s";
+    else
+        line << "?";
+
+    if (_file.empty()) {
+        std::cerr << line.str() << std::endl;
+    } else {
+        //The status file only keeps the last report
+        std::ofstream os(_file.c_str(), std::ios::out | std::ios::trunc);
+        if (os.good()) {
+            os << line.str() << "\n";
+            os << std::setprecision(0) << std::fixed;
+            for (unsigned int i = 0; i < n; i++) {
+                os << "%%   worker " << i
+                   << " : nodes/s " << nps[i]
+                   << " problems " << _monitor.worker(i).problems
+                   << (_monitor.worker(i).idle ? " idle" : "") << "\n";
+            }
+        }
+    }
+}
+
+void
+ProgressReporter::run(void) {
+    _timer.start();
+    double next = _interval;
+    while (!_monitor._stop) {
+        Gecode::Support::Thread::sleep(std::min(_interval, 100U));
+        if (_timer.stop() >= next) {
+            report();
+            next += _interval;
+        }
+    }
+    //Last report when the search is over
+    report();
+    //The monitor must not be used after this point
+    _monitor._e_stopped.signal();
+}
+
+ProgressMonitor::ProgressMonitor(unsigned int n)
+    : problems(0), dispatched(0), decomposed(false), solutions(0),
+      has_incumbent(false), incumbent(0),
+      _n_workers(n), _stop(false), _running(false) {
+    //Align the counters on a cache line to avoid false sharing between workers
+    _mem = Gecode::heap.ralloc(n * sizeof(WorkerProgress) + __CACHE_LINE__);
+    size_t a = reinterpret_cast<size_t>(_mem);
+    a = (a + __CACHE_LINE__ - 1) & ~static_cast<size_t>(__CACHE_LINE__ - 1);
+    _workers = reinterpret_cast<WorkerProgress*>(a);
+    memset(_workers, 0, n * sizeof(WorkerProgress));
+}
+
+void
+ProgressMonitor::start(unsigned int interval, const std::string& file) {
+    if (interval == 0 || _running)
+        return;
+    _stop = false;
+    _running = true;
+    Gecode::Support::Thread::run(new ProgressReporter(*this, interval, file));
+}
+
+void
+ProgressMonitor::stop(void) {
+    if (!_running)
+        return;
+    _stop = true;
+    _e_stopped.wait();
+    _running = false;
+}
+
+ProgressMonitor::~ProgressMonitor(void) {
+    stop();
+    Gecode::heap.rfree(_mem);
+}
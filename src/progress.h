@@ -0,0 +1,130 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* progress.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __PROGRESS_H__
+#define __PROGRESS_H__
+
+#include <gecode/support.hh>
+
+#include <string>
+
+#ifndef __CACHE_LINE__
+#define __CACHE_LINE__ 64
+#endif
+
+/// Counters of one eps worker (only written by this worker)
+struct WorkerCounters {
+    /// Explored nodes
+    volatile unsigned long int nodes;
+    /// Finished subproblems
+    volatile unsigned int problems;
+    /// Whether the worker waits for a subproblem
+    volatile bool idle;
+};
+
+/// Counters of one eps worker padded to a cache line
+struct WorkerProgress : public WorkerCounters {
+    char _padding[__CACHE_LINE__ - sizeof(WorkerCounters) % __CACHE_LINE__];
+};
+
+/// Solutions counted by one eps worker padded to a cache line (only written by this worker)
+struct SolutionCounter {
+    unsigned long int count;
+    char _padding[__CACHE_LINE__ - sizeof(unsigned long int)];
+};
+
+/**
+ * \brief Progress of an eps search
+ *
+ * The engine and its workers update the counters without any lock,
+ * the reporter thread only reads them. Values can be slightly outdated
+ * which is fine for a progress report.
+ */
+class ProgressMonitor {
+public:
+    /// Subproblems generated so far
+    volatile unsigned int problems;
+    /// Subproblems handed to workers
+    volatile unsigned int dispatched;
+    /// Whether the decomposition is done
+    volatile bool decomposed;
+    /// Solutions reported by the engine
+    volatile unsigned long int solutions;
+    /// Whether an incumbent exists (optimization only)
+    volatile bool has_incumbent;
+    /// Objective of the incumbent
+    volatile int incumbent;
+
+    /// Initialize for \a n workers
+    ProgressMonitor(unsigned int n);
+    /// Return number of workers
+    unsigned int workers(void) const;
+    /// Return counters of worker \a i
+    WorkerProgress& worker(unsigned int i);
+    /// Start a reporter thread writing every \a interval ms to \a file (stderr if empty)
+    void start(unsigned int interval, const std::string& file);
+    /// Stop the reporter thread (if any) and wait for its last report
+    void stop(void);
+    /// Destructor
+    ~ProgressMonitor(void);
+
+private:
+    friend class ProgressReporter;
+
+    unsigned int _n_workers;
+    /// Memory block of the counters (not aligned)
+    void* _mem;
+    WorkerProgress* _workers;
+
+    volatile bool _stop;
+    bool _running;
+    /// Signalled by the reporter once it is done
+    Gecode::Support::Event _e_stopped;
+};
+
+forceinline unsigned int
+ProgressMonitor::workers(void) const {
+    return _n_workers;
+}
+
+forceinline WorkerProgress&
+ProgressMonitor::worker(unsigned int i) {
+    return _workers[i];
+}
+
+#endif
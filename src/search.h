@@ -43,6 +43,7 @@
 #include <gecode/search/sequential/dfs.hh>
 
 #include "flatzinc.h"
+#include "writer.h"
 
 class MySearchOptions : public Gecode::Search::Options {
 public:
@@ -51,18 +52,63 @@ public:
     unsigned int mode_search;
     std::string  obj_file;   ///< objective file path
     unsigned int first_level;
-
-    MySearchOptions() : Gecode::Search::Options(), nb_problems(50), mode_decomposition(0), mode_search(0), obj_file(), first_level(0) {
+    unsigned int progress_interval; ///< interval in ms of progress reports (0 = none)
+    std::string  progress_file; ///< progress report file path (stderr if empty)
+    unsigned int order; ///< dispatch order of the subproblems
+    unsigned int probe_nodes; ///< node limit of the hardness probe (lpt order)
+    unsigned int affinity; ///< placement of the workers on the cpus
+    unsigned int chunk_size; ///< subproblems handed to a worker at once
+    unsigned int chunk; ///< chunking of the subproblem dispatch
+    unsigned int chunk_time; ///< targeted duration of an adaptive chunk (ms)
+    size_t memory_budget; ///< memory budget of the decomposition, 0 for none (bytes)
+    unsigned int stream_batch; ///< subproblems generated at once by the streamed decomposition
+    unsigned int solution_limit; ///< solutions after which the search stops, 0 for all
+    bool count_only; ///< only count the solutions
+    ShardOutput* shards; ///< output of the solutions printed by the eps workers, NULL if they are reported
+    unsigned int restart; ///< restart sequence of the workers inside a subproblem (Gecode::RestartMode)
+    unsigned int restart_scale; ///< scale of the restart sequence (failures)
+    double restart_base; ///< base of the geometric restart sequence
+    std::vector<int> portfolio; ///< branching variants raced on the same subproblems by groups of workers, empty for none
+    unsigned int lns_relax; ///< percentage of the integer variables relaxed by an lns neighbourhood
+    unsigned int lns_fails; ///< failures after which an lns neighbourhood is abandoned
+    unsigned int lns_neighbourhood; ///< choice of the variables relaxed by an lns neighbourhood
+    unsigned int seed; ///< seed of the random choices of the workers
+    bool deterministic; ///< solutions and bounds committed in subproblem order
+
+    MySearchOptions() : Gecode::Search::Options(), nb_problems(50), mode_decomposition(0), mode_search(0), obj_file(), first_level(0),
+        progress_interval(0), progress_file(), order(0), probe_nodes(100), affinity(0), chunk_size(1), chunk(0), chunk_time(10), memory_budget(0), stream_batch(1000), solution_limit(0), count_only(false), shards(NULL), restart(0), restart_scale(250), restart_base(1.5), portfolio(), lns_relax(30), lns_fails(500), lns_neighbourhood(0), seed(0), deterministic(false) {
     }
-    MySearchOptions(const Gecode::Search::Options& opt) : Gecode::Search::Options(opt), nb_problems(50), mode_decomposition(0), mode_search(0), obj_file(), first_level(0) {
+    MySearchOptions(const Gecode::Search::Options& opt) : Gecode::Search::Options(opt), nb_problems(50), mode_decomposition(0), mode_search(0), obj_file(), first_level(0),
+        progress_interval(0), progress_file(), order(0), probe_nodes(100), affinity(0), chunk_size(1), chunk(0), chunk_time(10), memory_budget(0), stream_batch(1000), solution_limit(0), count_only(false), shards(NULL), restart(0), restart_scale(250), restart_base(1.5), portfolio(), lns_relax(30), lns_fails(500), lns_neighbourhood(0), seed(0), deterministic(false) {
     }
 
     MySearchOptions(const MySearchOptions& opt) : Gecode::Search::Options(opt),
-        nb_problems(opt.nb_problems), mode_decomposition(opt.mode_decomposition), mode_search(opt.mode_search), obj_file(opt.obj_file), first_level(opt.first_level) {
+        nb_problems(opt.nb_problems), mode_decomposition(opt.mode_decomposition), mode_search(opt.mode_search), obj_file(opt.obj_file), first_level(opt.first_level),
+        progress_interval(opt.progress_interval), progress_file(opt.progress_file), order(opt.order), probe_nodes(opt.probe_nodes), affinity(opt.affinity), chunk_size(opt.chunk_size), chunk(opt.chunk), chunk_time(opt.chunk_time), memory_budget(opt.memory_budget), stream_batch(opt.stream_batch), solution_limit(opt.solution_limit), count_only(opt.count_only), shards(opt.shards), restart(opt.restart), restart_scale(opt.restart_scale), restart_base(opt.restart_base), portfolio(opt.portfolio), lns_relax(opt.lns_relax), lns_fails(opt.lns_fails), lns_neighbourhood(opt.lns_neighbourhood), seed(opt.seed), deterministic(opt.deterministic) {
     }
 
 };
 
+/**
+ * \brief Cutoff sequence of the restarts of an eps worker inside a subproblem (NULL if the workers do not restart)
+ *
+ * Only growing sequences keep the resolution of a subproblem complete, a
+ * constant cutoff would restart forever a subproblem needing more failures.
+ */
+inline Gecode::Search::Cutoff*
+createWorkerCutoff(const MySearchOptions& o) {
+    switch(o.restart) {
+    case Gecode::RM_LINEAR:
+        return Gecode::Search::Cutoff::linear(o.restart_scale);
+    case Gecode::RM_LUBY:
+        return Gecode::Search::Cutoff::luby(o.restart_scale);
+    case Gecode::RM_GEOMETRIC:
+        return Gecode::Search::Cutoff::geometric(o.restart_scale, o.restart_base);
+    default:
+        return NULL;
+    }
+}
+
 /// Depth-first search engine implementation with limited depth
 class BoundedDFS : public Gecode::Search::Worker {
 private:
@@ -162,4 +208,30 @@ T* eps_bab(T* s, const MySearchOptions& o=Gecode::Search::Options::def);
 
 #include "eps_bab.hpp"
 
+/**
+ * \brief Parallel large neighbourhood search engine
+ *
+ * The workers repeatedly fix the integer variables of the best solution
+ * found so far but a relaxed subset, and search the neighbourhood left
+ * for a better solution with a failure limit. As for EPS_BAB, \a s must
+ * implement \code virtual void constrain(const T& t) \endcode
+ * \ingroup TaskModelSearch
+ */
+template<class T>
+class EPS_LNS : public Gecode::EngineBase {
+public:
+    /// Initialize engine for space \a s and options \a o
+    EPS_LNS(T* s, const MySearchOptions& o=Gecode::Search::Options::def);
+    /// Return next better solution (NULL, if none exists or search has been stopped)
+    T* next(void);
+    /// Return statistics
+    Gecode::Search::Statistics statistics(void) const;
+    /// Check whether engine has been stopped
+    bool stopped(void) const;
+    /// Return no-goods
+    Gecode::NoGoods& nogoods(void);
+};
+
+#include "eps_lns.hpp"
+
 #endif
@@ -0,0 +1,216 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* subproblem.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <gecode/search.hh>
+
+#include "flatzinc.h"
+#include "subproblem.h"
+
+double
+HardnessFeatures::estimate(void) const {
+    if(failed) {
+        return 0.0;
+    }
+    if(probe_complete) {
+        return log2(1.0 + probe_nodes);
+    }
+    return log2(1.0 + probe_nodes) + log_size + log2(1.0 + unassigned) + log2(1.0 + propagations);
+}
+
+void
+postSubProblem(MyFlatZincSpace* s, const Gecode::TupleSet& bool_tuples, const Gecode::TupleSet& int_tuples,
+               unsigned int first, unsigned int last) {
+    if(bool_tuples.tuples()) {
+        int arity_bool = bool_tuples.arity();
+        Gecode::TupleSet tuples;
+        for(unsigned int i = first; i < last; i++) {
+            tuples.add(Gecode::IntArgs(arity_bool, bool_tuples[i]));
+        }
+        tuples.finalize();
+
+        Gecode::BoolVarArgs vars(arity_bool);
+        for(int i = 0; i < arity_bool; i++) {
+            vars[i] = s->bv[i];
+        }
+        Gecode::extensional(*s, vars, tuples, Gecode::EPK_DEF, Gecode::ICL_DOM);
+    }
+
+    if(int_tuples.tuples()) {
+        int arity_int = int_tuples.arity();
+        Gecode::TupleSet tuples;
+        for(unsigned int i = first; i < last; i++) {
+            tuples.add(Gecode::IntArgs(arity_int, int_tuples[i]));
+        }
+        tuples.finalize();
+
+        Gecode::IntVarArgs vars(arity_int);
+        for(int i = 0; i < arity_int; i++) {
+            vars[i] = s->iv[i];
+        }
+        Gecode::extensional(*s, vars, tuples, Gecode::EPK_DEF, Gecode::ICL_DOM);
+    }
+}
+
+HardnessFeatures
+hardnessFeatures(MyFlatZincSpace* s, const Gecode::TupleSet& bool_tuples, const Gecode::TupleSet& int_tuples,
+                 unsigned int first, unsigned int last, unsigned int probe_nodes,
+                 const Gecode::Space* incumbent) {
+    HardnessFeatures f;
+
+    MyFlatZincSpace* space = static_cast<MyFlatZincSpace*>(s->clone(false));
+    postSubProblem(space, bool_tuples, int_tuples, first, last);
+    if(incumbent) {
+        space->constrain(*incumbent);
+    }
+
+    Gecode::StatusStatistics sstat;
+    if(space->status(sstat) == Gecode::SS_FAILED) {
+        f.failed = true;
+        delete space;
+        return f;
+    }
+    f.propagations = sstat.propagate;
+
+    for(int i = 0; i < space->bv.size(); i++) {
+        if(!space->bv[i].assigned()) {
+            f.unassigned++;
+            f.log_size += 1.0;
+        }
+    }
+    for(int i = 0; i < space->iv.size(); i++) {
+        if(!space->iv[i].assigned()) {
+            f.unassigned++;
+            f.log_size += log2(static_cast<double>(space->iv[i].size()));
+        }
+    }
+
+    if(probe_nodes == 0 || f.unassigned == 0) {
+        f.probe_complete = (f.unassigned == 0);
+        delete space;
+        return f;
+    }
+
+    //First-fail probe, the space given to the engine is owned by it
+    Gecode::branch(*space, space->bv, Gecode::INT_VAR_SIZE_MIN(), Gecode::INT_VAL_MIN());
+    Gecode::branch(*space, space->iv, Gecode::INT_VAR_SIZE_MIN(), Gecode::INT_VAL_MIN());
+
+    Gecode::Search::Options o;
+    o.clone = false;
+    o.stop = new Gecode::Search::NodeStop(probe_nodes);
+    {
+        Gecode::DFS<MyFlatZincSpace> probe(space, o);
+        while(MyFlatZincSpace* solution = probe.next()) {
+            delete solution;
+        }
+        f.probe_nodes = probe.statistics().node;
+        f.probe_complete = !probe.stopped();
+    }
+    delete o.stop;
+
+    return f;
+}
+
+void
+estimateHardness(MyFlatZincSpace* s, const std::vector<int>& group_tuples,
+                 const Gecode::TupleSet& bool_tuples, const Gecode::TupleSet& int_tuples,
+                 unsigned int probe_nodes, std::vector<double>& hardness,
+                 const Gecode::Space* incumbent) {
+    hardness.clear();
+    hardness.reserve(group_tuples.size());
+
+    unsigned int first = 0;
+    for(size_t i = 0; i < group_tuples.size(); i++) {
+        unsigned int last = first + group_tuples[i];
+        hardness.push_back(hardnessFeatures(s, bool_tuples, int_tuples, first, last, probe_nodes, incumbent).estimate());
+        first = last;
+    }
+}
+
+/// Ranks of \a x, tied values get the average of their ranks
+static std::vector<double>
+ranks(const std::vector<double>& x) {
+    std::vector<size_t> index(x.size());
+    for(size_t i = 0; i < index.size(); i++) {
+        index[i] = i;
+    }
+    std::sort(index.begin(), index.end(), [&x](size_t a, size_t b) {
+        return x[a] < x[b];
+    });
+
+    std::vector<double> r(x.size());
+    for(size_t i = 0; i < index.size();) {
+        size_t j = i;
+        while(j + 1 < index.size() && x[index[j + 1]] == x[index[i]]) {
+            j++;
+        }
+        double rank = (i + j) / 2.0 + 1.0;
+        for(size_t k = i; k <= j; k++) {
+            r[index[k]] = rank;
+        }
+        i = j + 1;
+    }
+    return r;
+}
+
+double
+rankCorrelation(const std::vector<double>& x, const std::vector<double>& y) {
+    if(x.size() != y.size() || x.size() < 2) {
+        return 0.0;
+    }
+
+    std::vector<double> rx = ranks(x);
+    std::vector<double> ry = ranks(y);
+
+    //Pearson correlation of the ranks
+    double n = rx.size();
+    double mean = (n + 1.0) / 2.0;
+    double cov = 0.0, var_x = 0.0, var_y = 0.0;
+    for(size_t i = 0; i < rx.size(); i++) {
+        cov += (rx[i] - mean) * (ry[i] - mean);
+        var_x += (rx[i] - mean) * (rx[i] - mean);
+        var_y += (ry[i] - mean) * (ry[i] - mean);
+    }
+
+    if(var_x == 0.0 || var_y == 0.0) {
+        return 0.0;
+    }
+    return cov / sqrt(var_x * var_y);
+}
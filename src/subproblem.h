@@ -0,0 +1,154 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* subproblem.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __SUBPROBLEM_H__
+#define __SUBPROBLEM_H__
+
+#include <gecode/int.hh>
+
+#include <vector>
+
+class MyFlatZincSpace;
+
+/**
+ * \brief A subproblem of the decomposition
+ *
+ * The decomposition stores the subproblems as consecutive tuples of a
+ * group of tuple sets (one group per decomposition batch). A subproblem
+ * is the range [first_tuple, first_tuple+nb_tuples) of its group.
+ */
+struct SubProblem {
+    /// Rank of the subproblem in generation order
+    unsigned int id;
+    /// Index of the group of tuple sets holding the subproblem
+    unsigned int group;
+    /// First tuple of the subproblem in its group
+    unsigned int first_tuple;
+    /// Number of tuples of the subproblem
+    unsigned int nb_tuples;
+    /// Estimated hardness (0 if not estimated)
+    double hardness;
+
+    SubProblem(void)
+        : id(0), group(0), first_tuple(0), nb_tuples(0), hardness(0.0) {
+    }
+
+    SubProblem(unsigned int i, unsigned int g, unsigned int f, unsigned int n, double h)
+        : id(i), group(g), first_tuple(f), nb_tuples(n), hardness(h) {
+    }
+};
+
+/// Order on subproblems putting the estimated hardest first
+struct HarderSubProblem {
+    bool operator()(const SubProblem& a, const SubProblem& b) const {
+        return a.hardness > b.hardness;
+    }
+};
+
+/// Cheap hardness features of a subproblem
+struct HardnessFeatures {
+    /// Whether propagation failed the subproblem
+    bool failed;
+    /// Log2 of the size of the search space left after propagation
+    double log_size;
+    /// Decision variables unassigned after propagation
+    unsigned int unassigned;
+    /// Propagator executions to reach the fixpoint of the subproblem
+    unsigned long int propagations;
+    /// Nodes explored by the probe
+    unsigned long int probe_nodes;
+    /// Whether the probe explored the whole subproblem
+    bool probe_complete;
+
+    HardnessFeatures(void)
+        : failed(false), log_size(0.0), unassigned(0), propagations(0),
+          probe_nodes(0), probe_complete(false) {
+    }
+
+    /**
+     * \brief Estimated hardness (only meaningful to rank subproblems)
+     *
+     * A subproblem exhausted by the probe is ranked by its probe size,
+     * below any subproblem the probe could not finish. The others are
+     * ranked by the log of their search space, depth and cost of a node.
+     */
+    double estimate(void) const;
+};
+
+/// Trace of a solved subproblem
+struct SubProblemTrace {
+    /// Rank of the subproblem in generation order
+    unsigned int id;
+    /// Estimated hardness
+    double hardness;
+    /// Time to solve the subproblem in ms
+    unsigned int time;
+
+    SubProblemTrace(unsigned int i, double h, unsigned int t)
+        : id(i), hardness(h), time(t) {
+    }
+};
+
+/// Post the subproblem made of tuples [\a first, \a last) of \a bool_tuples and \a int_tuples on \a s
+void postSubProblem(MyFlatZincSpace* s, const Gecode::TupleSet& bool_tuples, const Gecode::TupleSet& int_tuples,
+                    unsigned int first, unsigned int last);
+
+/**
+ * \brief Compute the hardness features of a subproblem
+ *
+ * The subproblem is posted on a clone of \a s and propagated, then probed
+ * by a first-fail depth-first search limited to \a probe_nodes nodes
+ * (no probe if 0). \a s must be stable and is not modified. For an
+ * optimization, \a incumbent (if not NULL) constrains the clone as in
+ * branch and bound: without it the subproblems that the incumbent prunes
+ * look the hardest.
+ */
+HardnessFeatures hardnessFeatures(MyFlatZincSpace* s, const Gecode::TupleSet& bool_tuples, const Gecode::TupleSet& int_tuples,
+                                  unsigned int first, unsigned int last, unsigned int probe_nodes,
+                                  const Gecode::Space* incumbent = NULL);
+
+/// Estimate the hardness of each subproblem of a decomposition batch described by \a group_tuples
+void estimateHardness(MyFlatZincSpace* s, const std::vector<int>& group_tuples,
+                      const Gecode::TupleSet& bool_tuples, const Gecode::TupleSet& int_tuples,
+                      unsigned int probe_nodes, std::vector<double>& hardness,
+                      const Gecode::Space* incumbent = NULL);
+
+/// Spearman rank correlation of \a x and \a y (0 if undefined)
+double rankCorrelation(const std::vector<double>& x, const std::vector<double>& y);
+
+#endif /* __SUBPROBLEM_H__ */
@@ -0,0 +1,85 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* trajectory.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <cstdlib>
+#include <algorithm>
+
+#include "trajectory.h"
+#include "stl_util.h"
+
+std::string
+trajectoryString(const std::vector<TrajectoryPoint>& trajectory) {
+    std::string s;
+    for(size_t i = 0; i < trajectory.size(); i++) {
+        const TrajectoryPoint& p = trajectory[i];
+        s += stl_util::Convert2String(p.time) + ":" + stl_util::Convert2String(p.objective) + ":"
+             + (p.worker >= 0 ? stl_util::Convert2String(p.worker) : std::string("-")) + ":"
+             + (p.subproblem >= 0 ? stl_util::Convert2String(p.subproblem) : std::string("-")) + " ";
+    }
+    return s;
+}
+
+double
+primalGap(int objective, int reference) {
+    if(objective == reference) {
+        return 0.0;
+    }
+    //Objectives of opposite signs are as far as can be
+    if((objective < 0 && reference > 0) || (objective > 0 && reference < 0)) {
+        return 1.0;
+    }
+    double a = std::abs(static_cast<double>(objective));
+    double b = std::abs(static_cast<double>(reference));
+    return std::abs(a - b) / std::max(a, b);
+}
+
+double
+primalIntegral(const std::vector<TrajectoryPoint>& trajectory, int reference, unsigned int horizon) {
+    double integral = 0.0;
+    unsigned int from = 0;
+    double gap = 1.0;
+    for(size_t i = 0; i < trajectory.size() && trajectory[i].time < horizon; i++) {
+        integral += gap * (trajectory[i].time - from);
+        from = trajectory[i].time;
+        gap = primalGap(trajectory[i].objective, reference);
+    }
+    if(horizon > from) {
+        integral += gap * (horizon - from);
+    }
+    return integral / 1000.0;
+}
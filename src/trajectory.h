@@ -0,0 +1,76 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* trajectory.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __TRAJECTORY_H__
+#define __TRAJECTORY_H__
+
+#include <vector>
+#include <string>
+
+/// Improving solution of an optimization run
+struct TrajectoryPoint {
+    /// Time the solution was found in ms (from the start of the run)
+    unsigned int time;
+    /// Objective of the solution
+    int objective;
+    /// Worker which found the solution (-1 if unknown, or found by the decomposition)
+    int worker;
+    /// Subproblem the solution was found in (-1 if none)
+    int subproblem;
+
+    TrajectoryPoint(unsigned int t, int o, int w, int sp)
+        : time(t), objective(o), worker(w), subproblem(sp) {
+    }
+};
+
+/// Points of \a trajectory as time:objective:worker:subproblem, '-' for unknown ids
+std::string trajectoryString(const std::vector<TrajectoryPoint>& trajectory);
+
+/// Primal gap of \a objective to the \a reference objective (in [0, 1])
+double primalGap(int objective, int reference);
+
+/**
+ * \brief Primal integral of \a trajectory over [0, \a horizon] ms (in seconds)
+ *
+ * Integral of the primal gap of the incumbent to \a reference, counted
+ * as 1 while there is no incumbent. The lower, the sooner good solutions
+ * were found, 0 if the reference is known from the start.
+ */
+double primalIntegral(const std::vector<TrajectoryPoint>& trajectory, int reference, unsigned int horizon);
+
+#endif /* __TRAJECTORY_H__ */
@@ -0,0 +1,164 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* writer.cpp													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#include <string>
+
+#include "writer.h"
+
+/// Runs the solution writer
+class SolutionWriterThread : public Gecode::Support::Runnable {
+private:
+    SolutionWriter& _writer;
+public:
+    SolutionWriterThread(SolutionWriter& w)
+        : _writer(w) {
+    }
+
+    virtual void run(void) {
+        _writer.run();
+    }
+};
+
+SolutionWriter::SolutionWriter(std::ostream& out, const Gecode::FlatZinc::Printer& p, unsigned int capacity)
+    : _out(out), _printer(p), _queue(capacity), _finished(false), _running(true) {
+    Gecode::Support::Thread::run(new SolutionWriterThread(*this));
+}
+
+SolutionWriter::~SolutionWriter(void) {
+    finish();
+}
+
+void
+SolutionWriter::push(MyFlatZincSpace* s) {
+    while(!_queue.push(s)) {
+        Gecode::Support::Thread::sleep(1);
+    }
+}
+
+void
+SolutionWriter::finish(void) {
+    if(!_running) {
+        return;
+    }
+    _finished = true;
+    _e_stopped.wait();
+    _running = false;
+}
+
+void
+SolutionWriter::run(void) {
+    std::ostringstream buffer;
+    while(true) {
+        //Read the flag first, the solutions pushed before it are then in the queue
+        bool finished = _finished;
+        __sync_synchronize();
+        MyFlatZincSpace* s;
+        bool printed = false;
+        while(_queue.pop(s)) {
+            s->print(buffer, _printer);
+            buffer << "----------\n";
+            delete s;
+            printed = true;
+            if(buffer.tellp() >= __WRITER_BUFFER__) {
+                const std::string& b = buffer.str();
+                _out.write(b.data(), b.size());
+                buffer.str("");
+            }
+        }
+        if(finished) {
+            break;
+        }
+        if(!printed) {
+            Gecode::Support::Thread::sleep(1);
+        }
+    }
+    const std::string& b = buffer.str();
+    _out.write(b.data(), b.size());
+    _out.flush();
+    _e_stopped.signal();
+}
+
+SolutionShard::SolutionShard(void)
+    : _file(NULL) {
+}
+
+SolutionShard::~SolutionShard(void) {
+    if(_file) {
+        fclose(_file);
+    }
+}
+
+void
+SolutionShard::print(const MyFlatZincSpace* s, const Gecode::FlatZinc::Printer& p) {
+    s->print(_buffer, p);
+    _buffer << "----------\n";
+    if(_buffer.tellp() >= __WRITER_BUFFER__) {
+        spill();
+    }
+}
+
+void
+SolutionShard::spill(void) {
+    if(!_file) {
+        _file = tmpfile();
+        if(!_file) {
+            //Keep everything in memory
+            return;
+        }
+    }
+    const std::string& b = _buffer.str();
+    fwrite(b.data(), 1, b.size(), _file);
+    _buffer.str("");
+}
+
+void
+SolutionShard::flush(std::ostream& out) {
+    if(_file) {
+        char chunk[1 << 16];
+        size_t n;
+        rewind(_file);
+        while((n = fread(chunk, 1, sizeof(chunk), _file)) > 0) {
+            out.write(chunk, n);
+        }
+        fclose(_file);
+        _file = NULL;
+    }
+    const std::string& b = _buffer.str();
+    out.write(b.data(), b.size());
+    _buffer.str("");
+}
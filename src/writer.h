@@ -0,0 +1,183 @@
+/*---------------------------------------------------------------------------*/
+/*                                                                           */
+/* writer.h													    */
+/*                                                                           */
+/* Author : Mohamed REZGUI (m.rezgui06@gmail.com)                              */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+/* Copyright (c) 2014 Mohamed REZGUI. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY MOHAMED REZGUI ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL MOHAMED REZGUI OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __WRITER_H__
+#define __WRITER_H__
+
+#include <gecode/support.hh>
+
+#include <cstdio>
+#include <sstream>
+#include <ostream>
+
+#include "flatzinc.h"
+
+#ifndef __CACHE_LINE__
+#define __CACHE_LINE__ 64
+#endif
+
+/// Output buffered before a write (bytes)
+#define __WRITER_BUFFER__ (1 << 20)
+
+/**
+ * \brief Bounded queue between one producer and one consumer thread
+ *
+ * The producer only moves the tail and the consumer only the head, each on
+ * its own cache line, so neither push nor pop takes a lock.
+ */
+template<class T>
+class SpscQueue {
+public:
+    /// Queue holding at least \a capacity elements
+    SpscQueue(unsigned int capacity)
+        : _head(0), _tail(0) {
+        unsigned int n = 1;
+        while(n < capacity) {
+            n <<= 1;
+        }
+        _mask = n - 1;
+        _items = Gecode::heap.alloc<T>(n);
+    }
+
+    ~SpscQueue(void) {
+        Gecode::heap.free<T>(_items, _mask + 1);
+    }
+
+    /// Append \a t, false if the queue is full (producer only)
+    bool push(const T& t) {
+        unsigned int tail = _tail;
+        if(tail - _head > _mask) {
+            return false;
+        }
+        _items[tail & _mask] = t;
+        //The element is written before the consumer can see it
+        __sync_synchronize();
+        _tail = tail + 1;
+        return true;
+    }
+
+    /// Remove the first element into \a t, false if the queue is empty (consumer only)
+    bool pop(T& t) {
+        unsigned int head = _head;
+        if(head == _tail) {
+            return false;
+        }
+        __sync_synchronize();
+        t = _items[head & _mask];
+        //The element is read before the producer can overwrite it
+        __sync_synchronize();
+        _head = head + 1;
+        return true;
+    }
+
+private:
+    T* _items;
+    unsigned int _mask;
+    char _padding0[__CACHE_LINE__];
+    /// Next element to pop
+    volatile unsigned int _head;
+    char _padding1[__CACHE_LINE__ - sizeof(unsigned int)];
+    /// Next free slot
+    volatile unsigned int _tail;
+    char _padding2[__CACHE_LINE__ - sizeof(unsigned int)];
+};
+
+/**
+ * \brief Thread printing the solutions
+ *
+ * The main thread pushes the solutions and goes on searching, the writer
+ * prints them in a large buffer written at once when full and frees them.
+ * The output is only flushed at the end.
+ */
+class SolutionWriter {
+public:
+    SolutionWriter(std::ostream& out, const Gecode::FlatZinc::Printer& p, unsigned int capacity = 1024);
+    ~SolutionWriter(void);
+
+    /// Print \a s after the solutions already pushed and delete it (waits while the queue is full)
+    void push(MyFlatZincSpace* s);
+    /// Print the pending solutions and stop the writer thread
+    void finish(void);
+
+    /// Print the solutions until finished (writer thread)
+    void run(void);
+
+private:
+    std::ostream& _out;
+    const Gecode::FlatZinc::Printer& _printer;
+    SpscQueue<MyFlatZincSpace*> _queue;
+    /// Set once the last solution is pushed
+    volatile bool _finished;
+    bool _running;
+    /// Signaled when the writer thread is done
+    Gecode::Support::Event _e_stopped;
+};
+
+/**
+ * \brief Solutions printed by one eps worker
+ *
+ * The output is buffered and spilled to a temporary file when the buffer is
+ * full, so workers never share a stream. The shards are concatenated to the
+ * output once the search is done.
+ */
+class SolutionShard {
+public:
+    SolutionShard(void);
+    ~SolutionShard(void);
+
+    /// Print the solution \a s
+    void print(const MyFlatZincSpace* s, const Gecode::FlatZinc::Printer& p);
+    /// Write the printed solutions to \a out and empty the shard
+    void flush(std::ostream& out);
+
+private:
+    /// Move the buffer to the temporary file
+    void spill(void);
+
+    std::ostringstream _buffer;
+    /// Temporary file (NULL until the first spill)
+    FILE* _file;
+};
+
+/// Where the eps workers print their solutions (shards printing)
+struct ShardOutput {
+    std::ostream* out;
+    const Gecode::FlatZinc::Printer* printer;
+};
+
+#endif /* __WRITER_H__ */